@@ -0,0 +1,169 @@
+#include "city_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace Benchmark {
+    using namespace std::literals;
+
+    namespace {
+        const double BASE_LATITUDE = 55.75;
+        const double BASE_LONGITUDE = 37.62;
+        const double METRS_IN_LATITUDE_DEGREE = 111'000.;
+        //доля перегонов с разной длиной в две стороны (односторонние улицы)
+        const double ASYMMETRIC_ROAD_RATIO = 0.1;
+
+        Geo::Coordinates ShiftCoordinates(double north_metrs, double east_metrs) {
+            const double lat = BASE_LATITUDE + north_metrs / METRS_IN_LATITUDE_DEGREE;
+            const double lng = BASE_LONGITUDE + east_metrs / (METRS_IN_LATITUDE_DEGREE * std::cos(BASE_LATITUDE * M_PI / 180.));
+            return {lat, lng};
+        }
+
+        // Раскладка остановок: координаты и соседи по улицам
+        class CityLayout {
+        public:
+            CityLayout(const CityOptions& options) : options_(options) {
+                if (options.layout == Layout::GRID) {
+                    width_ = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(options.stop_count))));
+                } else {
+                    width_ = std::max<size_t>(4, static_cast<size_t>(std::sqrt(static_cast<double>(options.stop_count))));
+                }
+            }
+
+            Geo::Coordinates GetCoordinates(size_t stop) const {
+                const double row = static_cast<double>(stop / width_);
+                const double column = static_cast<double>(stop % width_);
+                if (options_.layout == Layout::GRID) {
+                    return ShiftCoordinates(row * options_.stop_spacing, column * options_.stop_spacing);
+                }
+                //row - номер кольца, column - номер луча
+                const double radius = (row + 1.) * options_.stop_spacing;
+                const double angle = 2. * M_PI * column / static_cast<double>(width_);
+                return ShiftCoordinates(radius * std::cos(angle), radius * std::sin(angle));
+            }
+
+            std::vector<size_t> GetNeighbours(size_t stop) const {
+                std::vector<size_t> result;
+                const size_t row = stop / width_;
+                const size_t column = stop % width_;
+                auto add = [&](size_t neighbour_row, size_t neighbour_column) {
+                    const size_t neighbour = neighbour_row * width_ + neighbour_column;
+                    if (neighbour < options_.stop_count && neighbour != stop) {
+                        result.push_back(neighbour);
+                    }
+                };
+                if (row > 0) {
+                    add(row - 1, column);
+                }
+                add(row + 1, column);
+                if (options_.layout == Layout::GRID) {
+                    if (column > 0) {
+                        add(row, column - 1);
+                    }
+                    if (column + 1 < width_) {
+                        add(row, column + 1);
+                    }
+                } else {
+                    //кольцо замкнуто
+                    add(row, (column + 1) % width_);
+                    add(row, (column + width_ - 1) % width_);
+                }
+                return result;
+            }
+
+        private:
+            const CityOptions& options_;
+            //число столбцов решётки или лучей
+            size_t width_ = 1;
+        };
+    }
+
+    void GenerateCity(const CityOptions& options, TransportCatalogue::TransportCatalogue& catalogue) {
+        if (options.stop_count < 2 || options.stops_per_bus < 2) {
+            throw std::invalid_argument("City needs at least two stops and buses of at least two stops"s);
+        }
+        std::mt19937 generator(options.seed);
+        const CityLayout layout(options);
+
+        std::vector<std::string> stop_names;
+        std::vector<Geo::Coordinates> coordinates;
+        stop_names.reserve(options.stop_count);
+        coordinates.reserve(options.stop_count);
+        for (size_t stop = 0; stop < options.stop_count; ++stop) {
+            stop_names.push_back("S"s + std::to_string(stop));
+            coordinates.push_back(layout.GetCoordinates(stop));
+            catalogue.AddStop(stop_names.back(), coordinates.back());
+        }
+
+        std::uniform_real_distribution<double> unit(0., 1.);
+        std::uniform_real_distribution<double> detour(1., std::max(1., options.max_detour));
+        std::uniform_int_distribution<size_t> any_stop(0, options.stop_count - 1);
+        //перегоны, для которых расстояние уже задано
+        std::unordered_set<std::uint64_t> known_roads;
+        auto set_road = [&](size_t from, size_t to) {
+            const std::uint64_t key = static_cast<std::uint64_t>(from) * options.stop_count + to;
+            if (!known_roads.insert(key).second) {
+                return;
+            }
+            const double straight = Geo::ComputeDistance(coordinates[from], coordinates[to]);
+            catalogue.SetDistanceBetweenStops(stop_names[from], stop_names[to], std::round(straight * detour(generator)));
+            if (unit(generator) < ASYMMETRIC_ROAD_RATIO && known_roads.insert(static_cast<std::uint64_t>(to) * options.stop_count + from).second) {
+                catalogue.SetDistanceBetweenStops(stop_names[to], stop_names[from], std::round(straight * detour(generator)));
+            }
+        };
+
+        std::vector<size_t> path;
+        std::vector<std::string_view> bus_stops;
+        for (size_t bus = 0; bus < options.bus_count; ++bus) {
+            const bool is_roundtrip = unit(generator) < options.roundtrip_ratio;
+            //кольцевой автобус проходит путь туда и обратно, поэтому путь вдвое короче
+            const size_t path_size = is_roundtrip ? std::max<size_t>(2, options.stops_per_bus / 2 + 1) : options.stops_per_bus;
+
+            path.assign(1, any_stop(generator));
+            while (path.size() < path_size) {
+                auto neighbours = layout.GetNeighbours(path.back());
+                //без разворота на месте, если есть куда ехать дальше
+                if (path.size() > 1 && neighbours.size() > 1) {
+                    neighbours.erase(std::remove(neighbours.begin(), neighbours.end(), path[path.size() - 2]), neighbours.end());
+                }
+                if (neighbours.empty()) {
+                    break;
+                }
+                path.push_back(neighbours[std::uniform_int_distribution<size_t>(0, neighbours.size() - 1)(generator)]);
+            }
+            if (is_roundtrip) {
+                const std::vector<size_t> way_back(std::next(path.rbegin()), path.rend());
+                path.insert(path.end(), way_back.begin(), way_back.end());
+            }
+
+            bus_stops.clear();
+            for (size_t i = 0; i < path.size(); ++i) {
+                bus_stops.push_back(stop_names[path[i]]);
+                if (i > 0) {
+                    set_road(path[i - 1], path[i]);
+                }
+            }
+            catalogue.AddBus("B"s + std::to_string(bus), bus_stops, is_roundtrip);
+        }
+    }
+
+    Layout ParseLayout(const std::string& name) {
+        if (name == "grid"s) {
+            return Layout::GRID;
+        } else if (name == "radial"s) {
+            return Layout::RADIAL;
+        }
+        throw std::invalid_argument("Layout isn't correct"s);
+    }
+
+    std::string LayoutName(Layout layout) {
+        return layout == Layout::GRID ? "grid"s : "radial"s;
+    }
+
+}
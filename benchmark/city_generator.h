@@ -0,0 +1,40 @@
+#pragma once
+
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <string>
+
+namespace Benchmark {
+
+    enum class Layout {
+        GRID,
+        RADIAL
+    };
+
+    // Параметры синтетического города
+    struct CityOptions {
+        Layout layout = Layout::GRID;
+        size_t stop_count = 1000;
+        size_t bus_count = 100;
+        //число остановок, которые проходит автобус в одну сторону
+        size_t stops_per_bus = 20;
+        //доля кольцевых маршрутов
+        double roundtrip_ratio = 0.3;
+        //расстояние между соседними остановками по прямой, м
+        double stop_spacing = 400.;
+        //во сколько раз путь по дорогам длиннее пути по прямой: случайно в [1, max_detour]
+        double max_detour = 1.5;
+        std::uint32_t seed = 1;
+    };
+
+    // Заполняет справочник остановками S0..S{stop_count - 1} и автобусами B0..B{bus_count - 1}.
+    // Остановки стоят в узлах решётки (GRID) или на пересечениях колец и лучей (RADIAL),
+    // автобусы идут случайным блужданием по соседним узлам; кольцевые возвращаются тем же путём.
+    // Расстояния по дорогам задаются для всех соседних остановок автобусов, иногда разные в две стороны.
+    void GenerateCity(const CityOptions& options, TransportCatalogue::TransportCatalogue& catalogue);
+
+    Layout ParseLayout(const std::string& name);
+    std::string LayoutName(Layout layout);
+
+}
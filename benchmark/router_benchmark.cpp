@@ -0,0 +1,554 @@
+#include "city_generator.h"
+#include "json_builder.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Замер построения TransportRouter и времени ответа на запросы Route на синтетических городах.
+// Для каждой раскладки и числа остановок город генерируется один раз, затем для каждого алгоритма
+// измеряются время SetSettings, пиковая память процесса, перцентили времени GetRouteInfo, число обработанных
+// поиском вершин и попадания в кэши.
+// Для каждого города также сравнивается поиск остановки по имени в NameIndex справочника и в std::unordered_map,
+// а справочник, собранный поверх ресурса по умолчанию или арены (monotonic_buffer_resource), замеряется по памяти
+// после загрузки, после правок вперемешку с запросами и по времени освобождения.
+// Результаты печатаются в JSON (по умолчанию в stdout), ход работы - в stderr.
+//
+// Параметры (все необязательны):
+//   --routers=all_pairs,dijkstra,astar,bidirectional,contraction_hierarchy,raptor
+//   --layouts=grid,radial    --sizes=250,1000    --buses-per-stop=0.2    --stops-per-bus=20
+//   --roundtrip-ratio=0.3    --queries=1000      --seed=1                --output=results.json
+//   --tree-cache-mb=0        --route-cache-mb=0
+//   --distinct-queries=0 (запросы выбираются из стольких разных пар, 0 - все случайные)
+//   --name-lookups=100000 (поисков по имени в каждом индексе, 0 - без этого замера)
+//   --memory-resource=default (default или arena)    --catalogue-edits=100
+
+using namespace std::literals;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using TransportCatalogue::Info::Router::RouterType;
+
+    struct BenchmarkOptions {
+        std::vector<std::string> routers = {"all_pairs"s, "dijkstra"s, "astar"s, "bidirectional"s, "contraction_hierarchy"s, "raptor"s};
+        std::vector<std::string> layouts = {"grid"s, "radial"s};
+        std::vector<size_t> sizes = {250, 1000};
+        double buses_per_stop = 0.2;
+        size_t stops_per_bus = 20;
+        double roundtrip_ratio = 0.3;
+        size_t queries = 1000;
+        std::uint32_t seed = 1;
+        std::string output;
+        double tree_cache_mb = 0.;
+        double route_cache_mb = 0.;
+        size_t distinct_queries = 0;
+        size_t name_lookups = 100000;
+        std::string memory_resource = "default"s;
+        size_t catalogue_edits = 100;
+    };
+
+    struct RunResult {
+        std::string router;
+        std::string layout;
+        size_t stop_count = 0;
+        size_t bus_count = 0;
+        double build_ms = 0.;
+        size_t rss_before_kb = 0;
+        size_t peak_rss_kb = 0;
+        size_t queries = 0;
+        size_t found = 0;
+        double route_p50_us = 0.;
+        double route_p99_us = 0.;
+        double route_mean_us = 0.;
+        //вершин, обработанных поиском, в среднем и в худшем запросе
+        double settled_vertices_mean = 0.;
+        size_t settled_vertices_max = 0;
+        //только для dijkstra
+        size_t tree_cache_hits = 0;
+        size_t tree_cache_misses = 0;
+        size_t route_cache_hits = 0;
+        size_t route_cache_misses = 0;
+    };
+
+    struct CatalogueResult {
+        std::string memory_resource;
+        std::string layout;
+        size_t stop_count = 0;
+        size_t bus_count = 0;
+        double build_ms = 0.;
+        size_t rss_before_kb = 0;
+        size_t peak_rss_kb = 0;
+        //память, взятая справочником у ресурса (для арены - её блоки): после загрузки, в пике и после правок
+        size_t catalogue_kb = 0;
+        size_t catalogue_peak_kb = 0;
+        size_t edits = 0;
+        size_t catalogue_after_edits_kb = 0;
+        double teardown_ms = 0.;
+    };
+
+    struct NameLookupResult {
+        std::string layout;
+        size_t stop_count = 0;
+        size_t lookups = 0;
+        //доля имён, которые есть в справочнике
+        double hit_ratio = 0.;
+        double name_index_ns = 0.;
+        double unordered_map_ns = 0.;
+    };
+
+    std::vector<std::string> SplitList(const std::string& value) {
+        std::vector<std::string> result;
+        std::istringstream in(value);
+        for (std::string item; std::getline(in, item, ',');) {
+            if (!item.empty()) {
+                result.push_back(item);
+            }
+        }
+        return result;
+    }
+
+    BenchmarkOptions ParseOptions(int argc, char** argv) {
+        BenchmarkOptions options;
+        for (int i = 1; i < argc; ++i) {
+            const std::string argument = argv[i];
+            const size_t equal_pos = argument.find('=');
+            if (argument.rfind("--"s, 0) != 0 || equal_pos == std::string::npos) {
+                throw std::invalid_argument("Expected --name=value, got "s + argument);
+            }
+            const std::string name = argument.substr(2, equal_pos - 2);
+            const std::string value = argument.substr(equal_pos + 1);
+            if (name == "routers"s) {
+                options.routers = SplitList(value);
+            } else if (name == "layouts"s) {
+                options.layouts = SplitList(value);
+            } else if (name == "sizes"s) {
+                options.sizes.clear();
+                for (const auto& size : SplitList(value)) {
+                    options.sizes.push_back(std::stoul(size));
+                }
+            } else if (name == "buses-per-stop"s) {
+                options.buses_per_stop = std::stod(value);
+            } else if (name == "stops-per-bus"s) {
+                options.stops_per_bus = std::stoul(value);
+            } else if (name == "roundtrip-ratio"s) {
+                options.roundtrip_ratio = std::stod(value);
+            } else if (name == "queries"s) {
+                options.queries = std::stoul(value);
+            } else if (name == "seed"s) {
+                options.seed = static_cast<std::uint32_t>(std::stoul(value));
+            } else if (name == "output"s) {
+                options.output = value;
+            } else if (name == "tree-cache-mb"s) {
+                options.tree_cache_mb = std::stod(value);
+            } else if (name == "route-cache-mb"s) {
+                options.route_cache_mb = std::stod(value);
+            } else if (name == "distinct-queries"s) {
+                options.distinct_queries = std::stoul(value);
+            } else if (name == "name-lookups"s) {
+                options.name_lookups = std::stoul(value);
+            } else if (name == "memory-resource"s) {
+                if (value != "default"s && value != "arena"s) {
+                    throw std::invalid_argument("Memory resource should be default or arena"s);
+                }
+                options.memory_resource = value;
+            } else if (name == "catalogue-edits"s) {
+                options.catalogue_edits = std::stoul(value);
+            } else {
+                throw std::invalid_argument("Unknown option "s + name);
+            }
+        }
+        return options;
+    }
+
+    RouterType ParseRouterType(const std::string& name) {
+        static const std::unordered_map<std::string, RouterType> router_types = {
+            {"all_pairs"s, RouterType::ALL_PAIRS},
+            {"dijkstra"s, RouterType::DIJKSTRA},
+            {"astar"s, RouterType::ASTAR},
+            {"bidirectional"s, RouterType::BIDIRECTIONAL},
+            {"contraction_hierarchy"s, RouterType::CONTRACTION_HIERARCHY},
+            {"raptor"s, RouterType::RAPTOR},
+        };
+        const auto it = router_types.find(name);
+        if (it == router_types.end()) {
+            throw std::invalid_argument("Router type isn't correct"s);
+        }
+        return it->second;
+    }
+
+    // Поле из /proc/self/status в килобайтах, 0 - если недоступно
+    size_t ReadProcessMemoryKb(const std::string& field) {
+        std::ifstream status("/proc/self/status"s);
+        for (std::string line; std::getline(status, line);) {
+            if (line.rfind(field, 0) == 0) {
+                return std::stoul(line.substr(field.size()));
+            }
+        }
+        return 0;
+    }
+
+    // Сбрасывает пиковую память процесса (VmHWM) до текущей, чтобы замерить пик отдельного построения
+    void ResetPeakMemory() {
+        std::ofstream clear_refs("/proc/self/clear_refs"s);
+        clear_refs << "5";
+    }
+
+    // Передаёт выделения дальше и считает, сколько памяти занято сейчас и сколько было занято самое большее
+    class CountingResource : public std::pmr::memory_resource {
+    public:
+        explicit CountingResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource()) : upstream_(upstream) {
+        }
+
+        size_t GetBytes() const {
+            return bytes_;
+        }
+
+        size_t GetPeakBytes() const {
+            return peak_bytes_;
+        }
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override {
+            void* result = upstream_->allocate(bytes, alignment);
+            bytes_ += bytes;
+            peak_bytes_ = std::max(peak_bytes_, bytes_);
+            return result;
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+            upstream_->deallocate(p, bytes, alignment);
+            bytes_ -= bytes;
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+        std::pmr::memory_resource* upstream_ = nullptr;
+        size_t bytes_ = 0;
+        size_t peak_bytes_ = 0;
+    };
+
+    // Правки вперемешку с чтением: каждая добавляет остановку рядом со случайной, расстояние и автобус между ними,
+    // а запросы Stop и Bus сразу после неё заставляют справочник пересобрать списки автобусов остановок,
+    // строки расстояний и статистику
+    void RunCatalogueEdits(const BenchmarkOptions& options, TransportCatalogue::TransportCatalogue& catalogue,
+                           const std::vector<std::string_view>& stop_names) {
+        std::mt19937 generator(options.seed);
+        std::uniform_int_distribution<size_t> any_stop(0, stop_names.size() - 1);
+        for (size_t edit = 0; edit < options.catalogue_edits; ++edit) {
+            const std::string name = "Edit "s + std::to_string(edit);
+            const std::string_view from = stop_names[any_stop(generator)];
+            const auto coordinates = catalogue.GetStop(catalogue.GetReferenseStops().find(from)->second).coordinates;
+            catalogue.AddStop(name, {coordinates.lat + 0.001, coordinates.lng});
+            catalogue.SetDistanceBetweenStops(from, name, 150.);
+            catalogue.AddBus(name, {from, name}, false);
+            catalogue.GetInfoAboutStop(from);
+            catalogue.GetInfoAboutBus(name);
+        }
+    }
+
+    double GetPercentile(const std::vector<double>& sorted_values, double percentile) {
+        if (sorted_values.empty()) {
+            return 0.;
+        }
+        const size_t rank = static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted_values.size())));
+        return sorted_values[std::min(sorted_values.size(), std::max<size_t>(rank, 1)) - 1];
+    }
+
+    double GetHitRate(size_t hits, size_t misses) {
+        return hits + misses == 0 ? 0. : static_cast<double>(hits) / static_cast<double>(hits + misses);
+    }
+
+    RunResult RunRouter(const std::string& router_name, const BenchmarkOptions& options, TransportCatalogue::TransportCatalogue& catalogue,
+                        const std::vector<std::pair<std::string_view, std::string_view>>& queries) {
+        RunResult result;
+        result.router = router_name;
+        result.queries = queries.size();
+
+        TransportCatalogue::Router::TransportRouter router(catalogue);
+        TransportCatalogue::Info::Router::RoutingSettings settings;
+        settings.bus_velocity = 40.;
+        settings.bus_wait_time = 6.;
+        settings.router_type = ParseRouterType(router_name);
+        if (options.tree_cache_mb < 0. || options.route_cache_mb < 0.) {
+            throw std::invalid_argument("Cache size should be non-negative"s);
+        }
+        settings.tree_cache_bytes = static_cast<size_t>(options.tree_cache_mb * 1024. * 1024.);
+        settings.route_cache_bytes = static_cast<size_t>(options.route_cache_mb * 1024. * 1024.);
+
+        ResetPeakMemory();
+        result.rss_before_kb = ReadProcessMemoryKb("VmRSS:"s);
+        const auto build_start = Clock::now();
+        router.SetSettings(settings);
+        result.build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
+        result.peak_rss_kb = ReadProcessMemoryKb("VmHWM:"s);
+
+        std::vector<double> latencies;
+        latencies.reserve(queries.size());
+        size_t settled_vertices = 0;
+        for (const auto& query : queries) {
+            const auto query_start = Clock::now();
+            const auto route_info = router.GetRouteInfo(query);
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - query_start).count());
+            result.found += route_info.not_found ? 0 : 1;
+            settled_vertices += route_info.settled_vertices;
+            result.settled_vertices_max = std::max(result.settled_vertices_max, route_info.settled_vertices);
+        }
+        if (!queries.empty()) {
+            result.settled_vertices_mean = static_cast<double>(settled_vertices) / static_cast<double>(queries.size());
+        }
+        const auto route_cache_stats = router.GetRouteCacheStats();
+        result.route_cache_hits = route_cache_stats.hits;
+        result.route_cache_misses = route_cache_stats.misses;
+        if (const auto tree_cache_stats = router.GetTreeCacheStats()) {
+            result.tree_cache_hits = tree_cache_stats->hits;
+            result.tree_cache_misses = tree_cache_stats->misses;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        result.route_p50_us = GetPercentile(latencies, 0.5);
+        result.route_p99_us = GetPercentile(latencies, 0.99);
+        if (!latencies.empty()) {
+            double sum = 0.;
+            for (const double latency : latencies) {
+                sum += latency;
+            }
+            result.route_mean_us = sum / static_cast<double>(latencies.size());
+        }
+        return result;
+    }
+
+    // Среднее время поиска имени в наносекундах; сумма номеров найденного не даёт компилятору выбросить поиск
+    template <typename Index>
+    double MeasureNameLookups(const Index& index, const std::vector<std::string>& names, size_t lookups, size_t& checksum) {
+        const auto start = Clock::now();
+        for (size_t i = 0; i < lookups; ++i) {
+            const auto it = index.find(names[i % names.size()]);
+            checksum += it == index.end() ? 0 : it->second + 1;
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(lookups);
+    }
+
+    NameLookupResult RunNameLookups(const BenchmarkOptions& options, const TransportCatalogue::TransportCatalogue& catalogue) {
+        NameLookupResult result;
+        result.lookups = options.name_lookups;
+        const auto& name_index = catalogue.GetReferenseStops();
+        std::unordered_map<std::string_view, TransportCatalogue::StopId> unordered_map;
+        unordered_map.reserve(name_index.size());
+        for (const auto& [stop_name, stop_id] : name_index) {
+            unordered_map.emplace(stop_name, stop_id);
+        }
+
+        //копии имён, чтобы сравнение шло по содержимому, и каждое десятое - имя, которого нет
+        std::vector<std::string> names;
+        names.reserve(name_index.size() + name_index.size() / 10 + 1);
+        for (const auto& [stop_name, stop_id] : name_index) {
+            names.emplace_back(stop_name);
+            if (names.size() % 10 == 0) {
+                names.push_back("Missing "s + std::to_string(names.size()));
+            }
+        }
+        std::shuffle(names.begin(), names.end(), std::mt19937(options.seed));
+        size_t hits = 0;
+        for (const auto& name : names) {
+            hits += name_index.find(name) == name_index.end() ? 0 : 1;
+        }
+        result.hit_ratio = static_cast<double>(hits) / static_cast<double>(names.size());
+
+        //первый проход прогревает кэши процессора, замеряется второй
+        size_t name_index_checksum = 0;
+        size_t unordered_map_checksum = 0;
+        for (int pass = 0; pass < 2; ++pass) {
+            result.name_index_ns = MeasureNameLookups(name_index, names, options.name_lookups, name_index_checksum);
+            result.unordered_map_ns = MeasureNameLookups(unordered_map, names, options.name_lookups, unordered_map_checksum);
+        }
+        if (name_index_checksum != unordered_map_checksum) {
+            throw std::logic_error("NameIndex and unordered_map found different stops"s);
+        }
+        return result;
+    }
+
+    JSON::Dict PackCatalogueResultIntoJsonDict(const CatalogueResult& result) {
+        JSON::Builder builder;
+        builder.StartDict()
+               .Key("case"s).Value("catalogue"s)
+               .Key("memory_resource"s).Value(result.memory_resource)
+               .Key("layout"s).Value(result.layout)
+               .Key("stop_count"s).Value(static_cast<int>(result.stop_count))
+               .Key("bus_count"s).Value(static_cast<int>(result.bus_count))
+               .Key("build_ms"s).Value(result.build_ms)
+               .Key("rss_before_kb"s).Value(static_cast<int>(result.rss_before_kb))
+               .Key("peak_rss_kb"s).Value(static_cast<int>(result.peak_rss_kb))
+               .Key("catalogue_kb"s).Value(static_cast<int>(result.catalogue_kb))
+               .Key("catalogue_peak_kb"s).Value(static_cast<int>(result.catalogue_peak_kb))
+               .Key("edits"s).Value(static_cast<int>(result.edits))
+               .Key("catalogue_after_edits_kb"s).Value(static_cast<int>(result.catalogue_after_edits_kb))
+               .Key("teardown_ms"s).Value(result.teardown_ms);
+        return builder.EndDict().Build().AsDict();
+    }
+
+    JSON::Dict PackNameLookupResultIntoJsonDict(const NameLookupResult& result) {
+        JSON::Builder builder;
+        builder.StartDict()
+               .Key("case"s).Value("name_lookup"s)
+               .Key("layout"s).Value(result.layout)
+               .Key("stop_count"s).Value(static_cast<int>(result.stop_count))
+               .Key("lookups"s).Value(static_cast<int>(result.lookups))
+               .Key("hit_ratio"s).Value(result.hit_ratio)
+               .Key("name_index_ns"s).Value(result.name_index_ns)
+               .Key("unordered_map_ns"s).Value(result.unordered_map_ns);
+        return builder.EndDict().Build().AsDict();
+    }
+
+    JSON::Dict PackRunResultIntoJsonDict(const RunResult& result) {
+        JSON::Builder builder;
+        builder.StartDict()
+               .Key("case"s).Value("route"s)
+               .Key("router"s).Value(result.router)
+               .Key("layout"s).Value(result.layout)
+               .Key("stop_count"s).Value(static_cast<int>(result.stop_count))
+               .Key("bus_count"s).Value(static_cast<int>(result.bus_count))
+               .Key("build_ms"s).Value(result.build_ms)
+               .Key("rss_before_kb"s).Value(static_cast<int>(result.rss_before_kb))
+               .Key("peak_rss_kb"s).Value(static_cast<int>(result.peak_rss_kb))
+               .Key("queries"s).Value(static_cast<int>(result.queries))
+               .Key("found"s).Value(static_cast<int>(result.found))
+               .Key("route_p50_us"s).Value(result.route_p50_us)
+               .Key("route_p99_us"s).Value(result.route_p99_us)
+               .Key("route_mean_us"s).Value(result.route_mean_us)
+               .Key("settled_vertices_mean"s).Value(result.settled_vertices_mean)
+               .Key("settled_vertices_max"s).Value(static_cast<int>(result.settled_vertices_max))
+               .Key("tree_cache_hits"s).Value(static_cast<int>(result.tree_cache_hits))
+               .Key("tree_cache_misses"s).Value(static_cast<int>(result.tree_cache_misses))
+               .Key("tree_cache_hit_rate"s).Value(GetHitRate(result.tree_cache_hits, result.tree_cache_misses))
+               .Key("route_cache_hits"s).Value(static_cast<int>(result.route_cache_hits))
+               .Key("route_cache_misses"s).Value(static_cast<int>(result.route_cache_misses))
+               .Key("route_cache_hit_rate"s).Value(GetHitRate(result.route_cache_hits, result.route_cache_misses));
+        return builder.EndDict().Build().AsDict();
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const BenchmarkOptions options = ParseOptions(argc, argv);
+        JSON::Builder results;
+        results.StartArray();
+
+        for (const auto& layout_name : options.layouts) {
+            for (const size_t stop_count : options.sizes) {
+                Benchmark::CityOptions city;
+                city.layout = Benchmark::ParseLayout(layout_name);
+                city.stop_count = stop_count;
+                city.bus_count = std::max<size_t>(1, static_cast<size_t>(options.buses_per_stop * static_cast<double>(stop_count)));
+                city.stops_per_bus = options.stops_per_bus;
+                city.roundtrip_ratio = options.roundtrip_ratio;
+                city.seed = options.seed;
+
+                CatalogueResult catalogue_result;
+                catalogue_result.memory_resource = options.memory_resource;
+                catalogue_result.layout = layout_name;
+                catalogue_result.stop_count = stop_count;
+                catalogue_result.bus_count = city.bus_count;
+                //считается память, которую справочник (или арена под ним) берёт у кучи
+                CountingResource counting_resource;
+                std::optional<std::pmr::monotonic_buffer_resource> arena;
+                if (options.memory_resource == "arena"s) {
+                    arena.emplace(&counting_resource);
+                }
+                ResetPeakMemory();
+                catalogue_result.rss_before_kb = ReadProcessMemoryKb("VmRSS:"s);
+                const auto build_start = Clock::now();
+                auto catalogue_owner = std::make_unique<TransportCatalogue::TransportCatalogue>(arena ? &*arena : static_cast<std::pmr::memory_resource*>(&counting_resource));
+                TransportCatalogue::TransportCatalogue& catalogue = *catalogue_owner;
+                Benchmark::GenerateCity(city, catalogue);
+                catalogue_result.build_ms = std::chrono::duration<double, std::milli>(Clock::now() - build_start).count();
+                catalogue_result.peak_rss_kb = ReadProcessMemoryKb("VmHWM:"s);
+                catalogue_result.catalogue_kb = counting_resource.GetBytes() / 1024;
+
+                //одни и те же запросы для всех алгоритмов
+                std::vector<std::string_view> stop_names;
+                for (const auto& [stop_name, stop_id] : catalogue.GetReferenseStops()) {
+                    stop_names.push_back(stop_name);
+                }
+                std::sort(stop_names.begin(), stop_names.end());
+                std::mt19937 generator(options.seed);
+                std::uniform_int_distribution<size_t> any_stop(0, stop_names.size() - 1);
+                std::vector<std::pair<std::string_view, std::string_view>> queries;
+                queries.reserve(options.queries);
+                for (size_t i = 0; i < options.queries; ++i) {
+                    queries.emplace_back(stop_names[any_stop(generator)], stop_names[any_stop(generator)]);
+                }
+                //повторяющиеся пары, чтобы было видно работу кэшей
+                if (options.distinct_queries > 0 && options.distinct_queries < queries.size()) {
+                    std::uniform_int_distribution<size_t> any_query(0, options.distinct_queries - 1);
+                    for (size_t i = options.distinct_queries; i < queries.size(); ++i) {
+                        queries[i] = queries[any_query(generator)];
+                    }
+                }
+
+                if (options.name_lookups > 0) {
+                    NameLookupResult result = RunNameLookups(options, catalogue);
+                    result.layout = layout_name;
+                    result.stop_count = stop_count;
+                    std::cerr << layout_name << ' ' << stop_count << " name lookup: NameIndex " << result.name_index_ns
+                              << " ns, unordered_map " << result.unordered_map_ns << " ns" << std::endl;
+                    results.Value(PackNameLookupResultIntoJsonDict(result));
+                }
+
+                for (const auto& router_name : options.routers) {
+                    RunResult result = RunRouter(router_name, options, catalogue, queries);
+                    result.layout = layout_name;
+                    result.stop_count = stop_count;
+                    result.bus_count = city.bus_count;
+                    std::cerr << layout_name << ' ' << stop_count << ' ' << router_name
+                              << ": build " << result.build_ms << " ms, peak " << result.peak_rss_kb << " kB"
+                              << ", route p50 " << result.route_p50_us << " us, p99 " << result.route_p99_us << " us"
+                              << ", settled " << result.settled_vertices_mean << std::endl;
+                    results.Value(PackRunResultIntoJsonDict(result));
+                }
+
+                if (options.catalogue_edits > 0) {
+                    RunCatalogueEdits(options, catalogue, stop_names);
+                }
+                catalogue_result.edits = options.catalogue_edits;
+                catalogue_result.catalogue_after_edits_kb = counting_resource.GetBytes() / 1024;
+                catalogue_result.catalogue_peak_kb = counting_resource.GetPeakBytes() / 1024;
+                const auto teardown_start = Clock::now();
+                catalogue_owner.reset();
+                arena.reset();
+                catalogue_result.teardown_ms = std::chrono::duration<double, std::milli>(Clock::now() - teardown_start).count();
+                std::cerr << layout_name << ' ' << stop_count << " catalogue (" << options.memory_resource << "): build "
+                          << catalogue_result.build_ms << " ms, " << catalogue_result.catalogue_kb << " kB, after "
+                          << catalogue_result.edits << " edits " << catalogue_result.catalogue_after_edits_kb << " kB, teardown "
+                          << catalogue_result.teardown_ms << " ms" << std::endl;
+                results.Value(PackCatalogueResultIntoJsonDict(catalogue_result));
+            }
+        }
+
+        const JSON::Document document{results.EndArray().Build()};
+        if (options.output.empty()) {
+            JSON::Print(document, std::cout);
+            std::cout << std::endl;
+        } else {
+            std::ofstream out(options.output);
+            JSON::Print(document, out);
+            out << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
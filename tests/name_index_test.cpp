@@ -0,0 +1,120 @@
+#include "name_index.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "Check failed: " << what << std::endl;
+            std::exit(1);
+        }
+    }
+
+    //размер индекса после reserve(8)
+    constexpr size_t CAPACITY = 16;
+
+    // count имён с домашним слотом home в индексе на CAPACITY слотов
+    std::vector<std::string> MakeNamesWithHome(size_t home, size_t count) {
+        std::vector<std::string> names;
+        for (int i = 0; names.size() < count; ++i) {
+            std::string name = "N"s + std::to_string(i);
+            if ((names::HashName(name) & (CAPACITY - 1)) == home) {
+                names.push_back(std::move(name));
+            }
+        }
+        return names;
+    }
+
+    void CheckMatches(const names::NameIndex<std::uint32_t>& index, const std::map<std::string, std::uint32_t>& expected,
+                      const std::vector<std::string>& all_names) {
+        Check(index.size() == expected.size(), "index size matches");
+        for (const auto& name : all_names) {
+            const auto it = index.find(name);
+            const auto expected_it = expected.find(name);
+            if (expected_it == expected.end()) {
+                Check(it == index.end(), "erased name isn't found");
+            } else {
+                Check(it != index.end() && it->second == expected_it->second, "present name is found with its id");
+            }
+        }
+    }
+
+    // Цепочки из имён с одним домашним слотом у конца массива переходят через его начало; удаление из середины
+    // цепочки сдвигает хвост назад, и все оставшиеся имена находятся, а удалённые - нет
+    void TestEraseInCollidingChains() {
+        std::vector<std::string> all_names = MakeNamesWithHome(CAPACITY - 2, 5);
+        for (auto& name : MakeNamesWithHome(CAPACITY - 1, 3)) {
+            all_names.push_back(std::move(name));
+        }
+        for (auto& name : MakeNamesWithHome(1, 2)) {
+            all_names.push_back(std::move(name));
+        }
+
+        names::NameIndex<std::uint32_t> index;
+        index.reserve(8);
+        std::map<std::string, std::uint32_t> expected;
+        for (std::uint32_t id = 0; id < 10; ++id) {
+            index.insert_or_assign(all_names[id], id);
+            expected[all_names[id]] = id;
+        }
+        CheckMatches(index, expected, all_names);
+
+        for (const size_t i : {1, 6, 0, 9}) {
+            Check(index.erase(all_names[i]) == 1, "erase removes a present name");
+            Check(index.erase(all_names[i]) == 0, "erase of an absent name does nothing");
+            expected.erase(all_names[i]);
+            CheckMatches(index, expected, all_names);
+        }
+        for (const size_t i : {6, 1}) {
+            index.insert_or_assign(all_names[i], static_cast<std::uint32_t>(100 + i));
+            expected[all_names[i]] = static_cast<std::uint32_t>(100 + i);
+            CheckMatches(index, expected, all_names);
+        }
+        index.insert_or_assign(all_names[2], 42);
+        expected[all_names[2]] = 42;
+        CheckMatches(index, expected, all_names);
+    }
+
+    // Случайные вставки, удаления и повторные вставки против std::map, в том числе при росте индекса
+    void TestRandomOperations() {
+        std::vector<std::string> all_names;
+        for (int i = 0; i < 200; ++i) {
+            all_names.push_back("Stop "s + std::to_string(i));
+        }
+        std::mt19937 random(7);
+        names::NameIndex<std::uint32_t> index;
+        std::map<std::string, std::uint32_t> expected;
+        for (std::uint32_t step = 0; step < 5000; ++step) {
+            const auto& name = all_names[random() % all_names.size()];
+            if (random() % 3 == 0) {
+                Check(index.erase(name) == expected.erase(name), "erase reports whether the name was there");
+            } else {
+                index.insert_or_assign(name, step);
+                expected[name] = step;
+            }
+        }
+        CheckMatches(index, expected, all_names);
+        size_t visited = 0;
+        for (const auto& [name, id] : index) {
+            Check(expected.at(std::string(name)) == id, "iteration visits present names");
+            ++visited;
+        }
+        Check(visited == expected.size(), "iteration visits every name once");
+    }
+
+}
+
+int main() {
+    TestEraseInCollidingChains();
+    TestRandomOperations();
+    std::cout << "All tests passed" << std::endl;
+}
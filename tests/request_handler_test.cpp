@@ -0,0 +1,118 @@
+#include "map_renderer.h"
+#include "request_handler.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "Check failed: " << what << std::endl;
+            std::exit(1);
+        }
+    }
+
+    std::vector<std::string> GetBusesOnStop(const RequestHandler::RequestInfo& info) {
+        const auto& stop_info = std::get<TransportCatalogue::Info::Stop>(info);
+        return {stop_info.buses_on_stop.begin(), stop_info.buses_on_stop.end()};
+    }
+
+    // Две пачки запросов с изменением справочника между ними: вторая пачка отвечает только на свои запросы,
+    // а ответы первой остаются действительными после того, как обработчик заменил снимок справочника
+    void TestTwoBatchesWithCatalogueEdit() {
+        TransportCatalogue::TransportCatalogue catalogue;
+        catalogue.AddStop("A"sv, {55.60, 37.20});
+        catalogue.AddStop("B"sv, {55.61, 37.21});
+        catalogue.AddStop("C"sv, {55.62, 37.22});
+        catalogue.SetDistanceBetweenStops("A"sv, "B"sv, 1000);
+        catalogue.SetDistanceBetweenStops("B"sv, "C"sv, 1500);
+        catalogue.AddBus("1"sv, {"A"sv, "B"sv}, false);
+
+        MapRenderer::MapRenderer renderer;
+        MapRenderer::RenderSettings render_settings;
+        render_settings.width = 600;
+        render_settings.height = 400;
+        render_settings.padding = 50;
+        render_settings.color_palette = {svg::Color{"green"s}};
+        renderer.SetRenderSettings(std::move(render_settings));
+
+        TransportCatalogue::Router::TransportRouter router(catalogue);
+        TransportCatalogue::Info::Router::RoutingSettings routing_settings;
+        routing_settings.bus_velocity = 40.;
+        routing_settings.bus_wait_time = 6.;
+        router.SetSettings(routing_settings);
+
+        RequestHandler::RequestHandler handler(catalogue, renderer, router);
+        handler.AddStatRequest(1, "Stop"s, "B"s);
+        handler.AddStatRequest(2, "Bus"s, "1"s);
+        handler.ParseStats();
+        const auto first_batch = handler.GetRequestInfo();
+        Check(first_batch.size() == 2, "first batch answers its two requests");
+
+        catalogue.AddBus("2"sv, {"B"sv, "C"sv}, false);
+        handler.AddStatRequest(3, "Stop"s, "B"s);
+        handler.AddStatRequest(4, "Route"s, std::pair{"A"s, "C"s});
+        handler.ParseStats();
+        const auto second_batch = handler.GetRequestInfo();
+        Check(second_batch.size() == 2, "second batch doesn't repeat the first one");
+        Check(second_batch[0].first == 3 && second_batch[1].first == 4, "second batch answers only its own requests");
+
+        Check(GetBusesOnStop(first_batch[0].second) == std::vector{"1"s}, "first answer keeps the buses it was given");
+        Check(GetBusesOnStop(second_batch[0].second) == std::vector{"1"s, "2"s}, "second answer sees the new bus");
+        Check(!std::get<TransportCatalogue::Info::Route>(second_batch[1].second).not_found, "route uses the new bus");
+    }
+
+    // Маршрутизатор не отвечает по устаревшему графу, а после сокращения журнала изменений собирается заново
+    void TestRouterFollowsCatalogueVersion() {
+        TransportCatalogue::TransportCatalogue catalogue;
+        catalogue.AddStop("A"sv, {55.60, 37.20});
+        catalogue.AddStop("B"sv, {55.61, 37.21});
+        catalogue.AddStop("C"sv, {55.62, 37.22});
+        catalogue.SetDistanceBetweenStops("A"sv, "B"sv, 1000);
+        catalogue.SetDistanceBetweenStops("B"sv, "C"sv, 1500);
+        catalogue.AddBus("1"sv, {"A"sv, "B"sv}, false);
+
+        TransportCatalogue::Router::TransportRouter router(catalogue);
+        TransportCatalogue::Info::Router::RoutingSettings routing_settings;
+        routing_settings.bus_velocity = 40.;
+        routing_settings.bus_wait_time = 6.;
+        router.SetSettings(routing_settings);
+        const auto old_version = catalogue.GetVersion();
+
+        catalogue.AddBus("2"sv, {"B"sv, "C"sv}, false);
+        bool rejected = false;
+        try {
+            router.GetRouteInfo({"A"sv, "C"sv});
+        } catch (const std::logic_error&) {
+            rejected = true;
+        }
+        Check(rejected, "query before ApplyCatalogueChanges is rejected");
+        router.ApplyCatalogueChanges();
+        Check(!router.GetRouteInfo({"A"sv, "C"sv}).not_found, "route uses the applied bus");
+
+        for (int i = 0; i < 10000; ++i) {
+            catalogue.SetStopCoordinates("C"sv, {55.62 + (i % 2) * 0.01, 37.22});
+        }
+        Check(!catalogue.GetChangesSince(old_version), "journal drops old changes");
+        catalogue.RemoveBus("2"sv);
+        router.ApplyCatalogueChanges();
+        Check(router.GetRouteInfo({"A"sv, "C"sv}).not_found, "full rebuild sees the removed bus");
+    }
+
+}
+
+int main() {
+    TestTwoBatchesWithCatalogueEdit();
+    TestRouterFollowsCatalogueVersion();
+    std::cout << "All tests passed" << std::endl;
+}
@@ -0,0 +1,46 @@
+#include "thread_pool.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "Check failed: " << what << std::endl;
+            std::exit(1);
+        }
+    }
+
+    // Исключение из задачи доходит до вызывающего, а пул дожидается своих потоков и годится для следующей фазы
+    void TestExceptionFromTask() {
+        parallel::ThreadPool pool(4);
+        for (int round = 0; round < 100; ++round) {
+            bool thrown = false;
+            try {
+                pool.ParallelFor(64, [](size_t task) {
+                    if (task % 7 == 3) {
+                        throw std::runtime_error("task failed");
+                    }
+                });
+            } catch (const std::runtime_error&) {
+                thrown = true;
+            }
+            Check(thrown, "exception from a task reaches the caller");
+
+            std::atomic<size_t> done = 0;
+            pool.ParallelFor(64, [&](size_t) {
+                ++done;
+            });
+            Check(done == 64, "pool runs every task of the next phase");
+        }
+    }
+
+}
+
+int main() {
+    TestExceptionFromTask();
+    std::cout << "All tests passed" << std::endl;
+}
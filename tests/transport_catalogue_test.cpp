@@ -0,0 +1,154 @@
+#include "transport_catalogue.h"
+
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "Check failed: " << what << std::endl;
+            std::exit(1);
+        }
+    }
+
+    std::vector<std::string> GetBuses(const TransportCatalogue::Info::Stop& stop_info) {
+        return {stop_info.buses_on_stop.begin(), stop_info.buses_on_stop.end()};
+    }
+
+    // Ответы Stop указывают в общие списки автобусов без копии и остаются действительными
+    // после изменений справочника и после того, как справочник и снимок уничтожены
+    void TestStopAnswersShareBusLists() {
+        TransportCatalogue::Info::Stop old_answer;
+        TransportCatalogue::Info::Stop snapshot_answer;
+        {
+            auto catalogue = std::make_unique<TransportCatalogue::TransportCatalogue>();
+            catalogue->AddStop("A"sv, {55.60, 37.20});
+            catalogue->AddStop("B"sv, {55.61, 37.21});
+            catalogue->AddBus("2"sv, {"A"sv, "B"sv}, false);
+            catalogue->AddBus("1"sv, {"B"sv, "A"sv}, false);
+
+            old_answer = catalogue->GetInfoAboutStop("A"sv);
+            const auto same_answer = catalogue->GetInfoAboutStop("B"sv);
+            Check(old_answer.storage == same_answer.storage, "answers share one buffer between edits");
+
+            auto snapshot = catalogue->Freeze();
+            snapshot_answer = snapshot->GetInfoAboutStop("A"sv);
+            Check(snapshot_answer.storage == old_answer.storage, "snapshot shares bus lists with the catalogue");
+
+            catalogue->RemoveBus("2"sv);
+            const auto new_answer = catalogue->GetInfoAboutStop("A"sv);
+            Check(new_answer.storage != old_answer.storage, "edit builds new bus lists");
+            Check(GetBuses(new_answer) == std::vector{"1"s}, "new answer sees the removed bus");
+        }
+        Check(GetBuses(old_answer) == std::vector{"1"s, "2"s}, "old answer outlives the catalogue");
+        Check(GetBuses(snapshot_answer) == std::vector{"1"s, "2"s}, "snapshot answer outlives the snapshot");
+    }
+
+
+    // Расстояние в обратную сторону берётся из прямого, пока его не задали; повторно заданное заменяет прежнее,
+    // в том числе дважды до чтения
+    void TestDistanceOverwriteBothDirections() {
+        TransportCatalogue::TransportCatalogue catalogue;
+        catalogue.AddStop("A"sv, {55.60, 37.20});
+        catalogue.AddStop("B"sv, {55.61, 37.21});
+        catalogue.AddStop("C"sv, {55.62, 37.22});
+        catalogue.SetDistanceBetweenStops("A"sv, "B"sv, 1000);
+        Check(catalogue.GetDistanceBetweenStops(0, 1) == 1000, "distance A -> B");
+        Check(catalogue.GetDistanceBetweenStops(1, 0) == 1000, "B -> A falls back to A -> B");
+        Check(catalogue.GetDistanceBetweenStops(0, 2) == 0, "unset distance is 0");
+
+        catalogue.SetDistanceBetweenStops("B"sv, "A"sv, 2000);
+        Check(catalogue.GetDistanceBetweenStops(0, 1) == 1000, "A -> B keeps its own distance");
+        Check(catalogue.GetDistanceBetweenStops(1, 0) == 2000, "B -> A uses its own distance once set");
+
+        catalogue.SetDistanceBetweenStops("A"sv, "B"sv, 1500);
+        Check(catalogue.GetDistanceBetweenStops(0, 1) == 1500, "overwrite of a merged distance");
+        catalogue.SetDistanceBetweenStops("A"sv, "C"sv, 700);
+        catalogue.SetDistanceBetweenStops("A"sv, "C"sv, 800);
+        Check(catalogue.GetDistanceBetweenStops(0, 2) == 800, "last of two pending distances wins");
+        Check(catalogue.GetDistanceBetweenStops(2, 0) == 800, "C -> A falls back to the overwritten A -> C");
+        Check(catalogue.Freeze()->GetDistanceBetweenStops(1, 0) == 2000, "snapshot sees the same distances");
+    }
+
+    // Случайные расстояния из загрузки, по одному и снова загрузкой, вперемешку с чтениями, против std::map
+    void TestDistancesAgainstMap() {
+        std::deque<std::string> stop_names;
+        auto name = [&](size_t stop) -> std::string_view {
+            while (stop_names.size() <= stop) {
+                stop_names.push_back("S"s + std::to_string(stop_names.size()));
+            }
+            return stop_names[stop];
+        };
+        std::mt19937 random(7);
+        TransportCatalogue::TransportCatalogue catalogue;
+        std::map<std::pair<size_t, size_t>, int> expected;
+        auto add_random_distance = [&](TransportCatalogue::Input::BaseRequests* requests) {
+            const size_t from = random() % catalogue.GetStopCount();
+            const size_t to = random() % catalogue.GetStopCount();
+            const int length = 1 + random() % 1000;
+            if (requests) {
+                requests->distances.push_back({name(from), name(to), static_cast<double>(length)});
+            } else {
+                catalogue.SetDistanceBetweenStops(name(from), name(to), length);
+            }
+            expected[{from, to}] = length;
+        };
+        auto check = [&] {
+            for (size_t from = 0; from < catalogue.GetStopCount(); ++from) {
+                for (size_t to = 0; to < catalogue.GetStopCount(); ++to) {
+                    auto it = expected.find({from, to});
+                    if (it == expected.end()) {
+                        it = expected.find({to, from});
+                    }
+                    const double length = it == expected.end() ? 0. : it->second;
+                    Check(catalogue.GetDistanceBetweenStops(from, to) == length, "distance matches the map");
+                }
+            }
+        };
+
+        TransportCatalogue::Input::BaseRequests base;
+        for (size_t stop = 0; stop < 40; ++stop) {
+            base.stops.push_back({name(stop), {55. + stop * 0.001, 37.}});
+        }
+        catalogue.AddBaseRequests(base);
+        base.stops.clear();
+        for (int i = 0; i < 200; ++i) {
+            add_random_distance(&base);
+        }
+        catalogue.AddBaseRequests(base);
+        check();
+        for (int i = 0; i < 1000; ++i) {
+            if (i % 100 == 0) {
+                catalogue.AddStop(name(catalogue.GetStopCount()), {56., 37.});
+            }
+            add_random_distance(nullptr);
+            if (i % 50 == 0) {
+                check();
+            }
+        }
+        check();
+        TransportCatalogue::Input::BaseRequests more;
+        for (int i = 0; i < 200; ++i) {
+            add_random_distance(&more);
+        }
+        catalogue.AddBaseRequests(more);
+        check();
+    }
+
+}
+
+int main() {
+    TestStopAnswersShareBusLists();
+    TestDistanceOverwriteBothDirections();
+    TestDistancesAgainstMap();
+    std::cout << "All tests passed" << std::endl;
+}
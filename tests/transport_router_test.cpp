@@ -0,0 +1,306 @@
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+using namespace std::literals;
+
+namespace {
+
+    using TransportCatalogue::Info::Router::RouterType;
+
+    void Check(bool condition, const char* what) {
+        if (!condition) {
+            std::cerr << "Check failed: " << what << std::endl;
+            std::exit(1);
+        }
+    }
+
+    bool IsClose(double lhs, double rhs) {
+        return std::abs(lhs - rhs) <= 1e-9 * std::max(1., std::abs(lhs));
+    }
+
+    // Город side x side: линии вдоль строк и столбцов, часть из них кольцевые, и расстояния
+    // то в обе стороны, то только в одну
+    std::vector<std::string> MakeCity(TransportCatalogue::TransportCatalogue& catalogue, int side, unsigned seed) {
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<int> length(300, 3000);
+        std::vector<std::string> stop_names;
+        for (int i = 0; i < side * side; ++i) {
+            stop_names.push_back("S"s + std::to_string(i));
+            catalogue.AddStop(stop_names.back(), {55.6 + 0.01 * (i / side), 37.5 + 0.01 * (i % side)});
+        }
+        auto connect = [&](int from, int to) {
+            catalogue.SetDistanceBetweenStops(stop_names[from], stop_names[to], length(random));
+            if (random() % 2 == 0) {
+                catalogue.SetDistanceBetweenStops(stop_names[to], stop_names[from], length(random));
+            }
+        };
+        for (int line = 0; line < side; ++line) {
+            std::vector<std::string_view> row;
+            std::vector<std::string_view> column;
+            for (int i = 0; i < side; ++i) {
+                row.push_back(stop_names[line * side + i]);
+                column.push_back(stop_names[i * side + line]);
+                if (i > 0) {
+                    connect(line * side + i - 1, line * side + i);
+                    connect((i - 1) * side + line, i * side + line);
+                }
+            }
+            const bool is_roundtrip = line % 3 == 0;
+            if (is_roundtrip) {
+                connect(line * side + side - 1, line * side);
+                row.push_back(row.front());
+            } else {
+                row.insert(row.end(), std::next(row.rbegin()), row.rend());
+            }
+            column.insert(column.end(), std::next(column.rbegin()), column.rend());
+            catalogue.AddBus("R"s + std::to_string(line), row, is_roundtrip);
+            catalogue.AddBus("C"s + std::to_string(line), column, false);
+        }
+        return stop_names;
+    }
+
+    TransportCatalogue::Info::Router::RoutingSettings MakeSettings(RouterType router_type) {
+        TransportCatalogue::Info::Router::RoutingSettings settings;
+        settings.bus_velocity = 30.;
+        settings.bus_wait_time = 4.;
+        settings.router_type = router_type;
+        settings.router_threads = 2;
+        return settings;
+    }
+
+    std::unique_ptr<TransportCatalogue::Router::TransportRouter> MakeRouter(TransportCatalogue::TransportCatalogue& catalogue,
+                                                                           RouterType router_type) {
+        auto router = std::make_unique<TransportCatalogue::Router::TransportRouter>(catalogue);
+        auto settings = MakeSettings(router_type);
+        router->SetSettings(settings);
+        return router;
+    }
+
+    double SumItemTimes(const TransportCatalogue::Info::Route& route) {
+        double time = 0.;
+        for (const auto& item : route.items_) {
+            if (const auto* wait = std::get_if<TransportCatalogue::Info::Router::WaitInfo>(&item)) {
+                time += wait->time;
+            } else if (const auto* bus = std::get_if<TransportCatalogue::Info::Router::BusRouteInfo>(&item)) {
+                time += bus->time;
+            }
+        }
+        return time;
+    }
+
+    // Время маршрутов router совпадает с Dijkstra для всех пар остановок, а части маршрута складываются в это время
+    void CheckRoutesMatchDijkstra(const TransportCatalogue::Router::TransportRouter& router,
+                                  const TransportCatalogue::Router::TransportRouter& dijkstra_router,
+                                  const std::vector<std::string>& stop_names) {
+        for (const auto& from : stop_names) {
+            for (const auto& to : stop_names) {
+                const auto expected = dijkstra_router.GetRouteInfo({from, to});
+                const auto route = router.GetRouteInfo({from, to});
+                Check(route.not_found == expected.not_found, "engine finds the same pairs as Dijkstra");
+                if (!route.not_found) {
+                    Check(IsClose(route.total_time, expected.total_time), "engine finds routes as fast as Dijkstra");
+                    Check(IsClose(SumItemTimes(route), route.total_time), "route items add up to its time");
+                    const auto boardings = std::count_if(route.items_.begin(), route.items_.end(), [](const auto& item) {
+                        return std::holds_alternative<TransportCatalogue::Info::Router::BusRouteInfo>(item);
+                    });
+                    Check(boardings == 0 || route.transfer_count + 1 == static_cast<size_t>(boardings), "transfer count matches bus items");
+                }
+            }
+        }
+    }
+
+    // Все движки, включая RAPTOR без графа, отвечают как Dijkstra на сгенерированном городе и после правок, применённых к ним на ходу
+    void TestEnginesMatchDijkstra() {
+        const std::vector<RouterType> router_types = {RouterType::ALL_PAIRS, RouterType::ASTAR, RouterType::BIDIRECTIONAL,
+                                                      RouterType::CONTRACTION_HIERARCHY, RouterType::RAPTOR};
+        TransportCatalogue::TransportCatalogue catalogue;
+        auto stop_names = MakeCity(catalogue, 6, 2);
+        std::vector<std::unique_ptr<TransportCatalogue::Router::TransportRouter>> routers;
+        for (const RouterType router_type : router_types) {
+            routers.push_back(MakeRouter(catalogue, router_type));
+            CheckRoutesMatchDijkstra(*routers.back(), *MakeRouter(catalogue, RouterType::DIJKSTRA), stop_names);
+        }
+
+        catalogue.SetDistanceBetweenStops(stop_names[7], stop_names[8], 5000);
+        catalogue.SetStopCoordinates(stop_names[14], {55.7, 37.7});
+        catalogue.RemoveBus("C2"sv);
+        catalogue.AddStop("Express"sv, {55.63, 37.53});
+        catalogue.SetDistanceBetweenStops(stop_names[0], "Express"sv, 900);
+        catalogue.SetDistanceBetweenStops("Express"sv, stop_names[35], 1200);
+        catalogue.AddBus("E"sv, {stop_names[0], "Express"sv, stop_names[35]}, false);
+        stop_names.push_back("Express"s);
+        const auto dijkstra_router = MakeRouter(catalogue, RouterType::DIJKSTRA);
+        for (auto& router : routers) {
+            router->ApplyCatalogueChanges();
+            CheckRoutesMatchDijkstra(*router, *dijkstra_router, stop_names);
+        }
+    }
+
+    // Матрица времён совпадает с отдельными запросами Route к Dijkstra, в том числе для недостижимых остановок
+    void TestMatrixMatchesRoutes() {
+        TransportCatalogue::TransportCatalogue catalogue;
+        auto stop_names = MakeCity(catalogue, 5, 3);
+        catalogue.AddStop("Island"sv, {55.5, 37.4});
+        stop_names.push_back("Island"s);
+        const std::vector<std::string> stops_from(stop_names.begin(), stop_names.begin() + 8);
+        const std::vector<std::string> stops_to(stop_names.rbegin(), stop_names.rbegin() + 12);
+
+        const auto dijkstra_router = MakeRouter(catalogue, RouterType::DIJKSTRA);
+        for (const RouterType router_type : {RouterType::ALL_PAIRS, RouterType::DIJKSTRA, RouterType::ASTAR, RouterType::BIDIRECTIONAL,
+                                             RouterType::CONTRACTION_HIERARCHY, RouterType::RAPTOR}) {
+            const auto matrix = MakeRouter(catalogue, router_type)->GetMatrixInfo(stops_from, stops_to);
+            Check(matrix.total_times.size() == stops_from.size(), "matrix has a row per start stop");
+            for (size_t i = 0; i < stops_from.size(); ++i) {
+                Check(matrix.total_times[i].size() == stops_to.size(), "matrix has a column per end stop");
+                for (size_t j = 0; j < stops_to.size(); ++j) {
+                    const auto route = dijkstra_router->GetRouteInfo({stops_from[i], stops_to[j]});
+                    const auto& time = matrix.total_times[i][j];
+                    Check(time.has_value() == !route.not_found, "matrix finds the same pairs as Route");
+                    Check(!time || IsClose(*time, route.total_time), "matrix time equals Route time");
+                }
+            }
+        }
+    }
+
+    // Недоминируемые маршруты RAPTOR и поиска на графе совпадают по времени и числу пересадок. В наборе время
+    // растёт, а пересадки убывают, первый маршрут - самый быстрый, а ограничение пересадок выбирает лучший из допустимых
+    void TestParetoRoutes() {
+        TransportCatalogue::TransportCatalogue catalogue;
+        const auto stop_names = MakeCity(catalogue, 5, 5);
+        const auto graph_router = MakeRouter(catalogue, RouterType::DIJKSTRA);
+        const auto raptor_router = MakeRouter(catalogue, RouterType::RAPTOR);
+        size_t multi_route_pairs = 0;
+        for (const auto& from : stop_names) {
+            for (const auto& to : stop_names) {
+                const auto graph_routes = graph_router->GetParetoRoutesInfo({from, to}).routes;
+                const auto raptor_routes = raptor_router->GetParetoRoutesInfo({from, to}).routes;
+                Check(graph_routes.size() == raptor_routes.size(), "RAPTOR and graph search find the same number of labels");
+                for (size_t i = 0; i < graph_routes.size(); ++i) {
+                    Check(IsClose(graph_routes[i].total_time, raptor_routes[i].total_time)
+                          && graph_routes[i].transfer_count == raptor_routes[i].transfer_count, "RAPTOR and graph search find the same labels");
+                    Check(i == 0 || (graph_routes[i - 1].total_time < graph_routes[i].total_time
+                                     && graph_routes[i - 1].transfer_count > graph_routes[i].transfer_count), "labels don't dominate each other");
+                    Check(IsClose(SumItemTimes(raptor_routes[i]), raptor_routes[i].total_time), "pareto route items add up to its time");
+                }
+                multi_route_pairs += graph_routes.size() > 1;
+
+                const auto fastest = graph_router->GetRouteInfo({from, to});
+                Check(fastest.not_found == graph_routes.empty(), "pareto set is empty only without a route");
+                if (graph_routes.empty()) {
+                    continue;
+                }
+                Check(IsClose(graph_routes.front().total_time, fastest.total_time), "first label is the fastest route");
+                for (size_t max_transfers = 0; max_transfers < 4; ++max_transfers) {
+                    const auto best = std::find_if(graph_routes.begin(), graph_routes.end(), [&](const auto& route) {
+                        return route.transfer_count <= max_transfers;
+                    });
+                    for (const auto* router : {graph_router.get(), raptor_router.get()}) {
+                        const auto limited = router->GetRouteInfo({from, to}, max_transfers);
+                        Check(limited.not_found == (best == graph_routes.end()), "transfer limit finds a route only if a label fits");
+                        Check(limited.not_found || (IsClose(limited.total_time, best->total_time)
+                                                    && limited.transfer_count <= max_transfers), "transfer limit picks the fastest label that fits");
+                    }
+                }
+            }
+        }
+        Check(multi_route_pairs > 0, "city has pairs where fewer transfers cost time");
+    }
+
+    // Изохрона - ровно те остановки, до которых Dijkstra находит маршрут не дольше бюджета, с тем же временем,
+    // по возрастанию времени
+    void TestIsochroneMatchesRoutes() {
+        TransportCatalogue::TransportCatalogue catalogue;
+        const auto stop_names = MakeCity(catalogue, 5, 4);
+        const auto dijkstra_router = MakeRouter(catalogue, RouterType::DIJKSTRA);
+        for (const RouterType router_type : {RouterType::DIJKSTRA, RouterType::ALL_PAIRS, RouterType::RAPTOR}) {
+            const auto router = MakeRouter(catalogue, router_type);
+            for (const auto& from : {stop_names[0], stop_names[12]}) {
+                for (const double max_time : {0., 10., 25., 1000.}) {
+                    const auto isochrone = router->GetIsochroneInfo(from, max_time);
+                    std::map<std::string, double> reached;
+                    for (size_t i = 0; i < isochrone.stops.size(); ++i) {
+                        Check(i == 0 || isochrone.stops[i - 1].second <= isochrone.stops[i].second, "isochrone is sorted by time");
+                        reached.emplace(isochrone.stops[i].first, isochrone.stops[i].second);
+                    }
+                    Check(reached.size() == isochrone.stops.size(), "isochrone lists each stop once");
+                    for (const auto& to : stop_names) {
+                        const auto route = dijkstra_router->GetRouteInfo({from, to});
+                        const auto it = reached.find(to);
+                        //на границе бюджета сравнение зависит от округления
+                        if (!route.not_found && std::abs(route.total_time - max_time) < 1e-6) {
+                            continue;
+                        }
+                        Check((it != reached.end()) == (!route.not_found && route.total_time <= max_time), "isochrone has exactly the reachable stops");
+                        Check(it == reached.end() || IsClose(it->second, route.total_time), "isochrone time equals Route time");
+                    }
+                }
+            }
+        }
+    }
+
+    // Таблица всех пар сохраняется в файл, после изменения справочника файл перезаписывается,
+    // и маршрутизатор для того же справочника читает его без пересчёта
+    void TestRoutingDataFileRoundTrip() {
+        namespace fs = std::filesystem;
+        const fs::path path = fs::temp_directory_path() / "transport_router_test_routing_data.bin";
+        fs::remove(path);
+
+        TransportCatalogue::TransportCatalogue catalogue;
+        const auto stop_names = MakeCity(catalogue, 5, 1);
+        auto settings = MakeSettings(RouterType::ALL_PAIRS);
+        settings.routing_data_file = path.string();
+        TransportCatalogue::Router::TransportRouter router(catalogue);
+        router.SetSettings(settings);
+        Check(fs::exists(path), "routing data file is written on build");
+
+        //запись файла видна по времени изменения, сдвинутому в прошлое
+        const auto old_time = fs::last_write_time(path) - std::chrono::hours(1);
+        fs::last_write_time(path, old_time);
+        catalogue.SetDistanceBetweenStops(stop_names[0], stop_names[1], 100);
+        router.ApplyCatalogueChanges();
+        Check(fs::last_write_time(path) != old_time, "routing data file is rewritten after a live update");
+
+        fs::last_write_time(path, old_time);
+        auto loaded_settings = settings;
+        TransportCatalogue::Router::TransportRouter loaded_router(catalogue);
+        loaded_router.SetSettings(loaded_settings);
+        Check(fs::last_write_time(path) == old_time, "router for the same catalogue reads the file as is");
+
+        auto dijkstra_settings = MakeSettings(RouterType::DIJKSTRA);
+        TransportCatalogue::Router::TransportRouter dijkstra_router(catalogue);
+        dijkstra_router.SetSettings(dijkstra_settings);
+        for (const auto& from : stop_names) {
+            for (const auto& to : stop_names) {
+                const auto expected = dijkstra_router.GetRouteInfo({from, to});
+                const auto loaded = loaded_router.GetRouteInfo({from, to});
+                Check(loaded.not_found == expected.not_found && IsClose(loaded.total_time, expected.total_time),
+                      "loaded table answers like Dijkstra");
+            }
+        }
+        fs::remove(path);
+    }
+
+}
+
+int main() {
+    TestEnginesMatchDijkstra();
+    TestMatrixMatchesRoutes();
+    TestIsochroneMatchesRoutes();
+    TestParetoRoutes();
+    TestRoutingDataFileRoundTrip();
+    std::cout << "All tests passed" << std::endl;
+}
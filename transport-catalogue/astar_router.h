@@ -0,0 +1,274 @@
+#pragma once
+
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Целенаправленный поиск A*: очередь упорядочена по весу пути плюс нижней оценке остатка до цели.
+    // Оценка должна быть допустимой и согласованной, иначе найденный путь может оказаться не кратчайшим.
+    template <typename Weight>
+    class AStarRouter final : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterEngine<Weight>::RouteInfo;
+
+        AStarRouter(const Graph& graph, Heuristic<Weight> heuristic);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    private:
+        struct RouteInternalData {
+            Weight weight;
+            Weight estimate;
+            std::optional<EdgeId> prev_edge;
+        };
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        Heuristic<Weight> heuristic_;
+    };
+
+    // Двунаправленный A* со средним потенциалом p(v) = (h(v, to) - h(from, v)) / 2:
+    // прямой поиск идёт по ключу d(from, v) + p(v), обратный - по ключу d(v, to) - p(v),
+    // и поиск заканчивается, когда сумма минимальных ключей очередей не меньше лучшего найденного пути.
+    // Без оценки (нулевой потенциал) это обычный двунаправленный алгоритм Дейкстры.
+    template <typename Weight>
+    class BidirectionalRouter final : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterEngine<Weight>::RouteInfo;
+
+        explicit BidirectionalRouter(const Graph& graph, Heuristic<Weight> heuristic = nullptr);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+
+    private:
+        struct RouteInternalData {
+            Weight weight;
+            Weight potential;
+            // для прямого поиска - последнее ребро пути, для обратного - первое ребро пути до цели
+            std::optional<EdgeId> edge;
+        };
+        using RoutesInternalData = std::vector<std::optional<RouteInternalData>>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        Weight ComputePotential(VertexId vertex, VertexId from, VertexId to) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        Heuristic<Weight> heuristic_;
+    };
+
+    template <typename Weight>
+    AStarRouter<Weight>::AStarRouter(const Graph& graph, Heuristic<Weight> heuristic)
+        : graph_(graph)
+        , heuristic_(std::move(heuristic))
+    {
+        if (!heuristic_) {
+            throw std::invalid_argument("A* search needs a heuristic");
+        }
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename AStarRouter<Weight>::RouteInfo> AStarRouter<Weight>::BuildRoute(VertexId from,
+                                                                                           VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        std::vector<std::optional<RouteInternalData>> routes_internal_data(vertex_count);
+        size_t settled_vertices = 0;
+        Queue queue;
+
+        const Weight from_estimate = heuristic_(from, to);
+        routes_internal_data[from] = RouteInternalData{ZERO_WEIGHT, from_estimate, std::nullopt};
+        queue.emplace(from_estimate, from);
+
+        while (!queue.empty()) {
+            const auto [key, vertex] = queue.top();
+            queue.pop();
+            const auto& route = *routes_internal_data[vertex];
+            // устаревшая запись: после неё вес вершины уже уменьшился
+            if (key != route.weight + route.estimate) {
+                continue;
+            }
+            ++settled_vertices;
+            if (vertex == to) {
+                break;
+            }
+            const Weight weight = route.weight;
+            const auto arcs = graph_.GetOutgoingArcs(vertex);
+            for (size_t arc = 0; arc < arcs.size; ++arc) {
+                const VertexId next_vertex = arcs.vertexes[arc];
+                const Weight candidate_weight = weight + arcs.weights[arc];
+                auto& route_relaxing = routes_internal_data[next_vertex];
+                if (!route_relaxing) {
+                    route_relaxing = RouteInternalData{candidate_weight, heuristic_(next_vertex, to), arcs.edge_ids[arc]};
+                } else if (candidate_weight < route_relaxing->weight) {
+                    route_relaxing->weight = candidate_weight;
+                    route_relaxing->prev_edge = arcs.edge_ids[arc];
+                } else {
+                    continue;
+                }
+                queue.emplace(candidate_weight + route_relaxing->estimate, next_vertex);
+            }
+        }
+
+        const auto& route_internal_data = routes_internal_data[to];
+        if (!route_internal_data) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
+             edge_id;
+             edge_id = routes_internal_data[graph_.GetEdge(*edge_id).from]->prev_edge)
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{route_internal_data->weight, std::move(edges), settled_vertices};
+    }
+
+    template <typename Weight>
+    BidirectionalRouter<Weight>::BidirectionalRouter(const Graph& graph, Heuristic<Weight> heuristic)
+        : graph_(graph)
+        , heuristic_(std::move(heuristic))
+    {
+        if (!graph.IsFrozen() || !graph.HasIncomingArcs()) {
+            throw std::logic_error("Graph should be frozen with incoming arcs before bidirectional routing");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    Weight BidirectionalRouter<Weight>::ComputePotential(VertexId vertex, VertexId from, VertexId to) const {
+        if (!heuristic_) {
+            return ZERO_WEIGHT;
+        }
+        return (heuristic_(vertex, to) - heuristic_(from, vertex)) / 2;
+    }
+
+    template <typename Weight>
+    std::optional<typename BidirectionalRouter<Weight>::RouteInfo> BidirectionalRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                           VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        if (from == to) {
+            return RouteInfo{ZERO_WEIGHT, {}, 0};
+        }
+
+        RoutesInternalData forward(vertex_count);
+        RoutesInternalData backward(vertex_count);
+        Queue forward_queue;
+        Queue backward_queue;
+        size_t settled_vertices = 0;
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+
+        auto update_best = [&](VertexId vertex) {
+            if (forward[vertex] && backward[vertex]) {
+                const Weight weight = forward[vertex]->weight + backward[vertex]->weight;
+                if (!best_weight || weight < *best_weight) {
+                    best_weight = weight;
+                    meeting_vertex = vertex;
+                }
+            }
+        };
+
+        const Weight from_potential = ComputePotential(from, from, to);
+        const Weight to_potential = ComputePotential(to, from, to);
+        forward[from] = RouteInternalData{ZERO_WEIGHT, from_potential, std::nullopt};
+        backward[to] = RouteInternalData{ZERO_WEIGHT, to_potential, std::nullopt};
+        forward_queue.emplace(from_potential, from);
+        backward_queue.emplace(-to_potential, to);
+
+        while (!forward_queue.empty() && !backward_queue.empty()) {
+            if (best_weight && forward_queue.top().first + backward_queue.top().first >= *best_weight) {
+                break;
+            }
+            const bool is_forward = forward_queue.top().first <= backward_queue.top().first;
+            Queue& queue = is_forward ? forward_queue : backward_queue;
+            RoutesInternalData& routes = is_forward ? forward : backward;
+
+            const auto [key, vertex] = queue.top();
+            queue.pop();
+            const Weight weight = routes[vertex]->weight;
+            const Weight potential = routes[vertex]->potential;
+            if (key != (is_forward ? weight + potential : weight - potential)) {
+                continue;
+            }
+            ++settled_vertices;
+
+            const auto arcs = is_forward ? graph_.GetOutgoingArcs(vertex) : graph_.GetIncomingArcs(vertex);
+            for (size_t arc = 0; arc < arcs.size; ++arc) {
+                const VertexId next_vertex = arcs.vertexes[arc];
+                const Weight candidate_weight = weight + arcs.weights[arc];
+                auto& route_relaxing = routes[next_vertex];
+                if (!route_relaxing) {
+                    route_relaxing = RouteInternalData{candidate_weight, ComputePotential(next_vertex, from, to), arcs.edge_ids[arc]};
+                } else if (candidate_weight < route_relaxing->weight) {
+                    route_relaxing->weight = candidate_weight;
+                    route_relaxing->edge = arcs.edge_ids[arc];
+                } else {
+                    continue;
+                }
+                queue.emplace(is_forward ? candidate_weight + route_relaxing->potential
+                                         : candidate_weight - route_relaxing->potential,
+                              next_vertex);
+                update_best(next_vertex);
+            }
+        }
+
+        if (!best_weight) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = forward[meeting_vertex]->edge;
+             edge_id;
+             edge_id = forward[graph_.GetEdge(*edge_id).from]->edge)
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        for (std::optional<EdgeId> edge_id = backward[meeting_vertex]->edge;
+             edge_id;
+             edge_id = backward[graph_.GetEdge(*edge_id).to]->edge)
+        {
+            edges.push_back(*edge_id);
+        }
+
+        return RouteInfo{*best_weight, std::move(edges), settled_vertices};
+    }
+
+}  // namespace graph
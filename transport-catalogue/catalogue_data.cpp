@@ -0,0 +1,58 @@
+#include "catalogue_data.h"
+
+#include <algorithm>
+
+
+namespace TransportCatalogue {
+
+	const RoadDistance* DistanceRows::Find(StopId from, StopId to) const {
+		if (from + size_t{1} >= offsets.size()) {
+			return nullptr;
+		}
+		const RoadDistance* row_end = distances + offsets[from + 1];
+		const RoadDistance* it = std::lower_bound(distances + offsets[from], row_end, to,
+												  [](const RoadDistance& distance, StopId stop) { return distance.to < stop; });
+		return it != row_end && it->to == to ? it : nullptr;
+	}
+
+	double DistanceRows::GetDistance(StopId from, StopId to) const {
+		if (const RoadDistance* distance = Find(from, to)) {
+			return distance->length;
+		}
+		if (const RoadDistance* distance = Find(to, from)) {
+			return distance->length;
+		}
+		return 0.;
+	}
+
+	BusStats ComputeBusStats(ranges::Range<const StopId*> stops, const Geo::Coordinates* stop_coordinates, const DistanceRows& distances) {
+		BusStats stats;
+		std::vector<StopId> unique_stop(stops.begin(), stops.end());
+		std::sort(unique_stop.begin(), unique_stop.end());
+		stats.count_of_unique_stops = std::unique(unique_stop.begin(), unique_stop.end()) - unique_stop.begin();
+		for (size_t i = 1; i < stops.size(); ++i) {
+			stats.geo_length += Geo::ComputeDistance(stop_coordinates[stops[i - 1]], stop_coordinates[stops[i]]);
+			stats.length += distances.GetDistance(stops[i - 1], stops[i]);
+		}
+		return stats;
+	}
+
+	Info::Bus MakeBusInfo(std::string_view bus_name, size_t count_of_stops, const BusStats& stats) {
+		Info::Bus businfo(bus_name);
+		businfo.no_bus = false;
+		businfo.count_of_stops = static_cast<int>(count_of_stops);
+		businfo.count_of_unique_stops = stats.count_of_unique_stops;
+		businfo.length = stats.length;
+		businfo.curvature = stats.length / stats.geo_length;
+		return businfo;
+	}
+
+	Info::Stop MakeStopInfo(std::string_view stop_name, const std::shared_ptr<const StopBuses>& stop_buses, StopId stop) {
+		Info::Stop stop_info(stop_name);
+		stop_info.not_found = false;
+		const std::string_view* bus_names = stop_buses->names.data();
+		stop_info.buses_on_stop = {bus_names + stop_buses->offsets[stop], bus_names + stop_buses->offsets[stop + 1]};
+		stop_info.storage = stop_buses;
+		return stop_info;
+	}
+}
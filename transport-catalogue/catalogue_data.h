@@ -0,0 +1,56 @@
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+#include "ranges.h"
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+
+namespace TransportCatalogue {
+
+	// Данные и код чтения, общие для справочника и его снимка
+
+	struct RoadDistance {
+		StopId to = 0;
+		int length = 0;
+	};
+
+	//неизменные между правками данные для запросов Bus
+	struct BusStats {
+		int count_of_unique_stops = 0;
+		//длина по дорогам и по прямой
+		double length = 0.;
+		double geo_length = 0.;
+	};
+
+	// Автобусы остановок. Собираются целиком при изменениях и дальше не меняются,
+	// поэтому справочник, его снимки и ответы Stop держат одни и те же строки через shared_ptr
+	struct StopBuses {
+		//автобусы остановки stop: buses[offsets[stop]..offsets[stop + 1]) по алфавиту, в names на тех же местах их имена
+		std::vector<size_t> offsets;
+		std::vector<BusId> buses;
+		std::vector<std::string_view> names;
+		//память, в которой лежат имена
+		std::shared_ptr<const void> names_storage;
+	};
+
+	// Строки расстояний: от остановки from - distances[offsets[from]..offsets[from + 1]), отсортированы по to.
+	// У остановок в конце строк может не быть
+	struct DistanceRows {
+		ranges::Range<const size_t*> offsets;
+		const RoadDistance* distances = nullptr;
+
+		const RoadDistance* Find(StopId from, StopId to) const;
+		//расстояние from -> to, если не задано - to -> from, если и его нет - 0
+		double GetDistance(StopId from, StopId to) const;
+	};
+
+	BusStats ComputeBusStats(ranges::Range<const StopId*> stops, const Geo::Coordinates* stop_coordinates, const DistanceRows& distances);
+	Info::Bus MakeBusInfo(std::string_view bus_name, size_t count_of_stops, const BusStats& stats);
+	// Ответ указывает в строки stop_buses и держит их
+	Info::Stop MakeStopInfo(std::string_view stop_name, const std::shared_ptr<const StopBuses>& stop_buses, StopId stop);
+}
@@ -0,0 +1,90 @@
+#include "catalogue_snapshot.h"
+#include "transport_catalogue.h"
+
+
+namespace TransportCatalogue {
+
+	CatalogueSnapshot::CatalogueSnapshot(const TransportCatalogue& catalogue)
+		: names_storage_(catalogue.names_resource_)
+		, stop_name_to_id_(catalogue.stop_name_to_id_)
+		, stop_names_(catalogue.stop_names_.begin(), catalogue.stop_names_.end())
+		, stop_coordinates_(catalogue.stop_coordinates_.begin(), catalogue.stop_coordinates_.end())
+		, bus_name_to_id_(catalogue.bus_name_to_id_)
+		, bus_names_(catalogue.bus_names_.begin(), catalogue.bus_names_.end())
+		, bus_is_roundtrip_(catalogue.bus_is_roundtrip_.begin(), catalogue.bus_is_roundtrip_.end())
+		, bus_is_removed_(catalogue.bus_is_removed_.begin(), catalogue.bus_is_removed_.end())
+		, bus_stop_offsets_(catalogue.bus_stop_offsets_.begin(), catalogue.bus_stop_offsets_.end())
+		, bus_stops_(catalogue.bus_stops_.begin(), catalogue.bus_stops_.end())
+		, version_(catalogue.GetVersion()) {
+		//достраиваем ленивые данные справочника, дальше только копируем
+		if (catalogue.stop_buses_outdated_) {
+			catalogue.UpdateStopBuses();
+		}
+		stop_buses_ = catalogue.stop_buses_;
+
+		const DistanceRows distances = catalogue.GetDistanceRows();
+		//у остановок без расстояний в конце справочника строк нет, здесь они пустые
+		distance_offsets_.assign(distances.offsets.begin(), distances.offsets.end());
+		distance_offsets_.resize(stop_names_.size() + 1, distance_offsets_.back());
+		distances_.assign(catalogue.distances_.begin(), catalogue.distances_.end());
+
+		bus_stats_.reserve(bus_names_.size());
+		for (BusId bus = 0; bus < bus_names_.size(); ++bus) {
+			bus_stats_.push_back(bus_is_removed_[bus] ? BusStats{} : catalogue.GetBusStats(bus));
+		}
+	}
+
+	const names::NameIndex<BusId>& CatalogueSnapshot::GetReferenseBuses() const {
+		return bus_name_to_id_;
+	}
+
+	const names::NameIndex<StopId>& CatalogueSnapshot::GetReferenseStops() const {
+		return stop_name_to_id_;
+	}
+
+	size_t CatalogueSnapshot::GetStopCount() const {
+		return stop_names_.size();
+	}
+
+	size_t CatalogueSnapshot::GetBusCount() const {
+		return bus_names_.size();
+	}
+
+	Stop CatalogueSnapshot::GetStop(StopId stop) const {
+		const BusId* buses = stop_buses_->buses.data();
+		return Stop{stop, stop_names_.at(stop), stop_coordinates_[stop],
+					{buses + stop_buses_->offsets[stop], buses + stop_buses_->offsets[stop + 1]}};
+	}
+
+	Bus CatalogueSnapshot::GetBus(BusId bus) const {
+		const StopId* stops = bus_stops_.data();
+		const size_t stops_end = bus_is_removed_.at(bus) ? bus_stop_offsets_[bus] : bus_stop_offsets_[bus + 1];
+		return Bus{bus, bus_names_[bus], {stops + bus_stop_offsets_[bus], stops + stops_end}, bus_is_roundtrip_[bus]};
+	}
+
+	Info::Bus CatalogueSnapshot::GetInfoAboutBus(std::string_view bus) const {
+		const auto pos = bus_name_to_id_.find(bus);
+		if (pos == bus_name_to_id_.end()) {
+			return Info::Bus(bus);
+		}
+		return MakeBusInfo(bus, bus_stop_offsets_[pos->second + 1] - bus_stop_offsets_[pos->second], bus_stats_[pos->second]);
+	}
+
+	Info::Stop CatalogueSnapshot::GetInfoAboutStop(std::string_view stop_name) const {
+		const auto pos = stop_name_to_id_.find(stop_name);
+		if (pos == stop_name_to_id_.end()) {
+			return Info::Stop(stop_name);
+		}
+		return MakeStopInfo(stop_name, stop_buses_, pos->second);
+	}
+
+	double CatalogueSnapshot::GetDistanceBetweenStops(StopId from, StopId to) const {
+		const size_t* offsets = distance_offsets_.data();
+		return DistanceRows{{offsets, offsets + distance_offsets_.size()}, distances_.data()}.GetDistance(from, to);
+	}
+
+	std::uint64_t CatalogueSnapshot::GetVersion() const {
+		return version_;
+	}
+
+}
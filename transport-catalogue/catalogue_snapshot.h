@@ -0,0 +1,71 @@
+#pragma once
+
+#include "catalogue_data.h"
+#include "domain.h"
+#include "geo.h"
+#include "name_index.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+
+namespace TransportCatalogue {
+
+	class TransportCatalogue;
+
+	// Неизменяемый снимок справочника, собирается TransportCatalogue::Freeze.
+	// Все данные, включая статистику автобусов, готовятся в конструкторе и дальше только читаются:
+	// ленивых пересборок и кэшей нет, поэтому снимком без блокировок пользуется любое число потоков.
+	// Имена и списки автобусов остановок справочник не меняет, а только дописывает или собирает заново,
+	// поэтому снимок делит их со справочником; остальные массивы копируются, статистика автобусов берётся
+	// уже посчитанной. Снимок может пережить справочник, но не его memory resource.
+	class CatalogueSnapshot {
+	public:
+		explicit CatalogueSnapshot(const TransportCatalogue& catalogue);
+
+		//представления указывают во внутренние массивы снимка
+		CatalogueSnapshot(const CatalogueSnapshot&) = delete;
+		CatalogueSnapshot& operator=(const CatalogueSnapshot&) = delete;
+
+		//имя -> номер, номера совпадают с номерами справочника
+		const names::NameIndex<BusId>& GetReferenseBuses() const;
+		const names::NameIndex<StopId>& GetReferenseStops() const;
+
+		size_t GetStopCount() const;
+		size_t GetBusCount() const;
+		Stop GetStop(StopId stop) const;
+		Bus GetBus(BusId bus) const;
+
+		Info::Bus GetInfoAboutBus(std::string_view bus) const;
+		Info::Stop GetInfoAboutStop(std::string_view stop) const;
+		double GetDistanceBetweenStops(StopId from, StopId to) const;
+
+		//версия справочника, с которой собран снимок
+		std::uint64_t GetVersion() const;
+
+	private:
+		//память имён справочника
+		std::shared_ptr<const void> names_storage_;
+
+		names::NameIndex<StopId> stop_name_to_id_;
+		std::vector<std::string_view> stop_names_;
+		std::vector<Geo::Coordinates> stop_coordinates_;
+		std::shared_ptr<const StopBuses> stop_buses_;
+
+		names::NameIndex<BusId> bus_name_to_id_;
+		std::vector<std::string_view> bus_names_;
+		std::vector<bool> bus_is_roundtrip_;
+		std::vector<bool> bus_is_removed_;
+		std::vector<size_t> bus_stop_offsets_;
+		std::vector<StopId> bus_stops_;
+		std::vector<BusStats> bus_stats_;
+
+		//расстояния от остановки from, отсортированы по to; строки есть у всех остановок
+		std::vector<size_t> distance_offsets_;
+		std::vector<RoadDistance> distances_;
+
+		std::uint64_t version_ = 0;
+	};
+}
@@ -0,0 +1,461 @@
+#pragma once
+
+#include "graph.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Иерархия сжатия (contraction hierarchies).
+    // При построении вершины по очереди исключаются из графа в порядке возрастания «важности»;
+    // если кратчайший путь между соседями исключаемой вершины шёл через неё, добавляется ребро-сокращение.
+    // Запрос - двунаправленный Дейкстра только по рёбрам, ведущим вверх по порядку исключения.
+    // Найденные сокращения раскрываются обратно в рёбра исходного графа.
+    // Матрица весов считается по «корзинам»: подъём по обратным дугам от каждой цели раскладывает
+    // по достигнутым вершинам веса путей до цели, затем подъём от каждого источника собирает лучшие суммы.
+    template <typename Weight>
+    class ContractionHierarchy final : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterEngine<Weight>::RouteInfo;
+        using WeightsMatrix = typename RouterEngine<Weight>::WeightsMatrix;
+
+        explicit ContractionHierarchy(const Graph& graph);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        WeightsMatrix BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                         const std::vector<VertexId>& targets) const override;
+
+        size_t GetShortcutCount() const noexcept;
+
+    private:
+        using ArcId = size_t;
+        static constexpr ArcId NO_ARC = std::numeric_limits<ArcId>::max();
+        // предел числа вершин в поиске свидетеля: если он исчерпан, сокращение добавляется на всякий случай
+        static constexpr size_t WITNESS_SEARCH_LIMIT = 500;
+
+        // Дуга иерархии: либо ребро исходного графа, либо сокращение из двух дуг
+        struct Arc {
+            VertexId from;
+            VertexId to;
+            Weight weight;
+            EdgeId edge_id = 0;
+            ArcId first = NO_ARC;
+            ArcId second = NO_ARC;
+        };
+
+        struct RouteInternalData {
+            Weight weight;
+            ArcId arc = NO_ARC;
+        };
+        using RoutesInternalData = std::vector<std::optional<RouteInternalData>>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        // Состояние, нужное только во время построения иерархии
+        class Builder {
+        public:
+            Builder(ContractionHierarchy& hierarchy, size_t vertex_count);
+            void ContractAll();
+
+        private:
+            // Возвращает число сокращений при исключении vertex; при add_shortcuts добавляет их в иерархию
+            size_t ProcessShortcuts(VertexId vertex, bool add_shortcuts);
+            void RunWitnessSearch(VertexId from, VertexId excluded_vertex, Weight max_weight);
+            int ComputePriority(VertexId vertex);
+            ArcId AddArc(Arc arc);
+
+            ContractionHierarchy& hierarchy_;
+            std::vector<std::vector<ArcId>> out_arcs_;
+            std::vector<std::vector<ArcId>> in_arcs_;
+            std::vector<bool> contracted_;
+            std::vector<int> contracted_neighbors_;
+
+            std::vector<std::optional<Weight>> witness_weights_;
+            std::vector<VertexId> witness_touched_;
+        };
+
+        void AddArcsToSearchGraph();
+        void AppendOriginalEdges(ArcId arc_id, std::vector<EdgeId>& edges) const;
+        // Полный подъём по иерархии от start: все достигнутые вершины и веса путей до них (или от них)
+        std::vector<std::pair<VertexId, Weight>> SearchUpward(VertexId start, bool is_forward) const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        std::vector<Arc> arcs_;
+        std::vector<size_t> rank_;
+        //дуги из вершины в вершины с большим рангом - для прямого поиска
+        std::vector<std::vector<ArcId>> upward_arcs_;
+        //дуги в вершину из вершин с большим рангом - для обратного поиска
+        std::vector<std::vector<ArcId>> downward_arcs_;
+    };
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::ContractionHierarchy(const Graph& graph)
+        : graph_(graph)
+        , rank_(graph.GetVertexCount(), 0)
+        , upward_arcs_(graph.GetVertexCount())
+        , downward_arcs_(graph.GetVertexCount())
+    {
+        Builder builder(*this, graph.GetVertexCount());
+        builder.ContractAll();
+        AddArcsToSearchGraph();
+    }
+
+    template <typename Weight>
+    size_t ContractionHierarchy<Weight>::GetShortcutCount() const noexcept {
+        return arcs_.size() - graph_.GetEdgeCount();
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::AddArcsToSearchGraph() {
+        for (ArcId arc_id = 0; arc_id < arcs_.size(); ++arc_id) {
+            const Arc& arc = arcs_[arc_id];
+            if (arc.from == arc.to) {
+                continue;
+            }
+            if (rank_[arc.from] < rank_[arc.to]) {
+                upward_arcs_[arc.from].push_back(arc_id);
+            } else {
+                downward_arcs_[arc.to].push_back(arc_id);
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename ContractionHierarchy<Weight>::RouteInfo> ContractionHierarchy<Weight>::BuildRoute(VertexId from,
+                                                                                                             VertexId to) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        if (from == to) {
+            return RouteInfo{ZERO_WEIGHT, {}, 0};
+        }
+
+        RoutesInternalData forward(vertex_count);
+        RoutesInternalData backward(vertex_count);
+        Queue forward_queue;
+        Queue backward_queue;
+        size_t settled_vertices = 0;
+        std::optional<Weight> best_weight;
+        VertexId meeting_vertex = from;
+
+        forward[from] = RouteInternalData{ZERO_WEIGHT, NO_ARC};
+        backward[to] = RouteInternalData{ZERO_WEIGHT, NO_ARC};
+        forward_queue.emplace(ZERO_WEIGHT, from);
+        backward_queue.emplace(ZERO_WEIGHT, to);
+
+        while (!forward_queue.empty() || !backward_queue.empty()) {
+            const bool is_forward = backward_queue.empty()
+                                    || (!forward_queue.empty() && forward_queue.top().first <= backward_queue.top().first);
+            Queue& queue = is_forward ? forward_queue : backward_queue;
+            // в иерархии нельзя остановиться при встрече: ждём, пока обе очереди не превысят лучший путь
+            if (best_weight && queue.top().first >= *best_weight) {
+                break;
+            }
+            RoutesInternalData& routes = is_forward ? forward : backward;
+            const RoutesInternalData& other_routes = is_forward ? backward : forward;
+
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > routes[vertex]->weight) {
+                continue;
+            }
+            ++settled_vertices;
+
+            for (const ArcId arc_id : is_forward ? upward_arcs_[vertex] : downward_arcs_[vertex]) {
+                const Arc& arc = arcs_[arc_id];
+                const VertexId next_vertex = is_forward ? arc.to : arc.from;
+                const Weight candidate_weight = weight + arc.weight;
+                auto& route_relaxing = routes[next_vertex];
+                if (route_relaxing && !(candidate_weight < route_relaxing->weight)) {
+                    continue;
+                }
+                route_relaxing = RouteInternalData{candidate_weight, arc_id};
+                queue.emplace(candidate_weight, next_vertex);
+                if (const auto& other_route = other_routes[next_vertex]) {
+                    if (!best_weight || candidate_weight + other_route->weight < *best_weight) {
+                        best_weight = candidate_weight + other_route->weight;
+                        meeting_vertex = next_vertex;
+                    }
+                }
+            }
+        }
+
+        if (!best_weight) {
+            return std::nullopt;
+        }
+        std::vector<ArcId> route_arcs;
+        for (ArcId arc_id = forward[meeting_vertex]->arc; arc_id != NO_ARC; arc_id = forward[arcs_[arc_id].from]->arc) {
+            route_arcs.push_back(arc_id);
+        }
+        std::reverse(route_arcs.begin(), route_arcs.end());
+        for (ArcId arc_id = backward[meeting_vertex]->arc; arc_id != NO_ARC; arc_id = backward[arcs_[arc_id].to]->arc) {
+            route_arcs.push_back(arc_id);
+        }
+
+        std::vector<EdgeId> edges;
+        for (const ArcId arc_id : route_arcs) {
+            AppendOriginalEdges(arc_id, edges);
+        }
+        return RouteInfo{*best_weight, std::move(edges), settled_vertices};
+    }
+
+    template <typename Weight>
+    typename ContractionHierarchy<Weight>::WeightsMatrix
+    ContractionHierarchy<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                     const std::vector<VertexId>& targets) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        for (const VertexId vertex : sources) {
+            if (vertex >= vertex_count) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+        }
+        //buckets[v] - номера целей, до которых дошёл обратный подъём в v, и веса путей из v до них
+        std::vector<std::vector<std::pair<size_t, Weight>>> buckets(vertex_count);
+        for (size_t j = 0; j < targets.size(); ++j) {
+            if (targets[j] >= vertex_count) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+            for (const auto& [vertex, weight] : SearchUpward(targets[j], false)) {
+                buckets[vertex].emplace_back(j, weight);
+            }
+        }
+
+        WeightsMatrix weights(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            auto& row = weights[i];
+            for (const auto& [vertex, weight] : SearchUpward(sources[i], true)) {
+                for (const auto& [j, bucket_weight] : buckets[vertex]) {
+                    if (!row[j] || weight + bucket_weight < *row[j]) {
+                        row[j] = weight + bucket_weight;
+                    }
+                }
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    std::vector<std::pair<VertexId, Weight>> ContractionHierarchy<Weight>::SearchUpward(VertexId start, bool is_forward) const {
+        RoutesInternalData routes(graph_.GetVertexCount());
+        std::vector<std::pair<VertexId, Weight>> settled;
+        Queue queue;
+        routes[start] = RouteInternalData{ZERO_WEIGHT, NO_ARC};
+        queue.emplace(ZERO_WEIGHT, start);
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > routes[vertex]->weight) {
+                continue;
+            }
+            settled.emplace_back(vertex, weight);
+            for (const ArcId arc_id : is_forward ? upward_arcs_[vertex] : downward_arcs_[vertex]) {
+                const Arc& arc = arcs_[arc_id];
+                const VertexId next_vertex = is_forward ? arc.to : arc.from;
+                const Weight candidate_weight = weight + arc.weight;
+                auto& route_relaxing = routes[next_vertex];
+                if (!route_relaxing || candidate_weight < route_relaxing->weight) {
+                    route_relaxing = RouteInternalData{candidate_weight, arc_id};
+                    queue.emplace(candidate_weight, next_vertex);
+                }
+            }
+        }
+        return settled;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::AppendOriginalEdges(ArcId arc_id, std::vector<EdgeId>& edges) const {
+        std::vector<ArcId> arcs_stack = {arc_id};
+        while (!arcs_stack.empty()) {
+            const Arc& arc = arcs_[arcs_stack.back()];
+            arcs_stack.pop_back();
+            if (arc.first == NO_ARC) {
+                edges.push_back(arc.edge_id);
+            } else {
+                arcs_stack.push_back(arc.second);
+                arcs_stack.push_back(arc.first);
+            }
+        }
+    }
+
+    template <typename Weight>
+    ContractionHierarchy<Weight>::Builder::Builder(ContractionHierarchy& hierarchy, size_t vertex_count)
+        : hierarchy_(hierarchy)
+        , out_arcs_(vertex_count)
+        , in_arcs_(vertex_count)
+        , contracted_(vertex_count, false)
+        , contracted_neighbors_(vertex_count, 0)
+        , witness_weights_(vertex_count)
+    {
+        const Graph& graph = hierarchy_.graph_;
+        hierarchy_.arcs_.reserve(graph.GetEdgeCount());
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            AddArc(Arc{edge.from, edge.to, edge.weight, edge_id});
+        }
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Builder::ContractAll() {
+        using PriorityItem = std::pair<int, VertexId>;
+        std::priority_queue<PriorityItem, std::vector<PriorityItem>, std::greater<PriorityItem>> order;
+        for (VertexId vertex = 0; vertex < contracted_.size(); ++vertex) {
+            order.emplace(ComputePriority(vertex), vertex);
+        }
+
+        size_t rank = 0;
+        while (!order.empty()) {
+            const VertexId vertex = order.top().second;
+            order.pop();
+            // ленивое обновление: если приоритет вырос и вершина больше не минимальна, откладываем её
+            const int priority = ComputePriority(vertex);
+            if (!order.empty() && priority > order.top().first) {
+                order.emplace(priority, vertex);
+                continue;
+            }
+
+            ProcessShortcuts(vertex, true);
+            contracted_[vertex] = true;
+            hierarchy_.rank_[vertex] = rank++;
+            for (const ArcId arc_id : out_arcs_[vertex]) {
+                ++contracted_neighbors_[hierarchy_.arcs_[arc_id].to];
+            }
+            for (const ArcId arc_id : in_arcs_[vertex]) {
+                ++contracted_neighbors_[hierarchy_.arcs_[arc_id].from];
+            }
+        }
+    }
+
+    template <typename Weight>
+    int ContractionHierarchy<Weight>::Builder::ComputePriority(VertexId vertex) {
+        int removed_arcs = 0;
+        for (const ArcId arc_id : out_arcs_[vertex]) {
+            removed_arcs += contracted_[hierarchy_.arcs_[arc_id].to] ? 0 : 1;
+        }
+        for (const ArcId arc_id : in_arcs_[vertex]) {
+            removed_arcs += contracted_[hierarchy_.arcs_[arc_id].from] ? 0 : 1;
+        }
+        const int shortcuts = static_cast<int>(ProcessShortcuts(vertex, false));
+        return shortcuts - removed_arcs + contracted_neighbors_[vertex];
+    }
+
+    template <typename Weight>
+    size_t ContractionHierarchy<Weight>::Builder::ProcessShortcuts(VertexId vertex, bool add_shortcuts) {
+        const std::vector<Arc>& arcs = hierarchy_.arcs_;
+        size_t shortcut_count = 0;
+        std::vector<Arc> shortcuts;
+
+        for (const ArcId in_arc_id : in_arcs_[vertex]) {
+            const VertexId from = arcs[in_arc_id].from;
+            if (contracted_[from] || from == vertex) {
+                continue;
+            }
+            const Weight in_weight = arcs[in_arc_id].weight;
+            std::optional<Weight> max_weight;
+            for (const ArcId out_arc_id : out_arcs_[vertex]) {
+                const VertexId to = arcs[out_arc_id].to;
+                if (!contracted_[to] && to != vertex && to != from) {
+                    const Weight weight = in_weight + arcs[out_arc_id].weight;
+                    max_weight = max_weight ? std::max(*max_weight, weight) : weight;
+                }
+            }
+            if (!max_weight) {
+                continue;
+            }
+
+            RunWitnessSearch(from, vertex, *max_weight);
+            for (const ArcId out_arc_id : out_arcs_[vertex]) {
+                const VertexId to = arcs[out_arc_id].to;
+                if (contracted_[to] || to == vertex || to == from) {
+                    continue;
+                }
+                const Weight weight = in_weight + arcs[out_arc_id].weight;
+                auto& witness_weight = witness_weights_[to];
+                if (witness_weight && !(weight < *witness_weight)) {
+                    continue;
+                }
+                // параллельная дуга в ту же вершину уже будет покрыта этим сокращением
+                if (!witness_weight) {
+                    witness_touched_.push_back(to);
+                }
+                witness_weight = weight;
+                ++shortcut_count;
+                if (add_shortcuts) {
+                    shortcuts.push_back(Arc{from, to, weight, 0, in_arc_id, out_arc_id});
+                }
+            }
+        }
+        for (const Arc& shortcut : shortcuts) {
+            AddArc(shortcut);
+        }
+        return shortcut_count;
+    }
+
+    template <typename Weight>
+    void ContractionHierarchy<Weight>::Builder::RunWitnessSearch(VertexId from, VertexId excluded_vertex, Weight max_weight) {
+        for (const VertexId vertex : witness_touched_) {
+            witness_weights_[vertex].reset();
+        }
+        witness_touched_.clear();
+
+        Queue queue;
+        witness_weights_[from] = ZERO_WEIGHT;
+        witness_touched_.push_back(from);
+        queue.emplace(ZERO_WEIGHT, from);
+        size_t settled_vertices = 0;
+
+        while (!queue.empty() && settled_vertices < WITNESS_SEARCH_LIMIT) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (weight > *witness_weights_[vertex]) {
+                continue;
+            }
+            if (max_weight < weight) {
+                break;
+            }
+            ++settled_vertices;
+            for (const ArcId arc_id : out_arcs_[vertex]) {
+                const Arc& arc = hierarchy_.arcs_[arc_id];
+                if (contracted_[arc.to] || arc.to == excluded_vertex) {
+                    continue;
+                }
+                const Weight candidate_weight = weight + arc.weight;
+                auto& witness_weight = witness_weights_[arc.to];
+                if (!witness_weight) {
+                    witness_touched_.push_back(arc.to);
+                } else if (!(candidate_weight < *witness_weight)) {
+                    continue;
+                }
+                witness_weight = candidate_weight;
+                queue.emplace(candidate_weight, arc.to);
+            }
+        }
+    }
+
+    template <typename Weight>
+    typename ContractionHierarchy<Weight>::ArcId ContractionHierarchy<Weight>::Builder::AddArc(Arc arc) {
+        auto& arcs = hierarchy_.arcs_;
+        arcs.push_back(arc);
+        const ArcId arc_id = arcs.size() - 1;
+        out_arcs_[arc.from].push_back(arc_id);
+        in_arcs_[arc.to].push_back(arc_id);
+        return arc_id;
+    }
+
+}  // namespace graph
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "graph.h"
+#include "lru_cache.h"
+#include "router_engine.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Поиск пути алгоритмом Дейкстры на каждый запрос по замороженному графу.
+    // В отличие от Router ничего не предвычисляет: память O(V + E), построение O(E).
+    // При ненулевом tree_cache_bytes деревья кратчайших путей от популярных вершин
+    // сохраняются в LRU-кэше, и повторный запрос из той же вершины лишь проходит по дереву.
+    // Матрица весов считается одним поиском на источник до всех целей сразу.
+    template <typename Weight>
+    class DijkstraRouter final : public RouterEngine<Weight> {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using RouteInfo = typename RouterEngine<Weight>::RouteInfo;
+        using WeightsMatrix = typename RouterEngine<Weight>::WeightsMatrix;
+
+        explicit DijkstraRouter(const Graph& graph, size_t tree_cache_bytes = 0);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        WeightsMatrix BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                         const std::vector<VertexId>& targets) const override;
+
+        cache::Stats GetTreeCacheStats() const;
+
+    private:
+        struct RouteInternalData {
+            Weight weight;
+            std::optional<EdgeId> prev_edge;
+        };
+        using RoutesInternalData = std::vector<std::optional<RouteInternalData>>;
+        using QueueItem = std::pair<Weight, VertexId>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        // поиск останавливается, как только достигнуты все вершины targets; при пустом targets строится всё дерево
+        RoutesInternalData ComputeRoutesInternalData(VertexId from, const std::vector<VertexId>& targets,
+                                                     size_t& settled_vertices) const;
+        std::optional<RouteInfo> ReconstructRoute(const RoutesInternalData& routes_internal_data, VertexId to) const;
+        size_t GetTreeBytes() const;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        mutable cache::LruCache<VertexId, std::shared_ptr<const RoutesInternalData>> tree_cache_;
+    };
+
+    template <typename Weight>
+    DijkstraRouter<Weight>::DijkstraRouter(const Graph& graph, size_t tree_cache_bytes)
+        : graph_(graph)
+        , tree_cache_(tree_cache_bytes)
+    {
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::optional<typename DijkstraRouter<Weight>::RouteInfo> DijkstraRouter<Weight>::BuildRoute(VertexId from,
+                                                                                                 VertexId to) const {
+        size_t settled_vertices = 0;
+        std::optional<RouteInfo> route_info;
+        if (GetTreeBytes() > tree_cache_.GetStats().capacity_bytes) {
+            route_info = ReconstructRoute(ComputeRoutesInternalData(from, {to}, settled_vertices), to);
+        } else {
+            auto tree = tree_cache_.Get(from);
+            if (!tree) {
+                tree = std::make_shared<const RoutesInternalData>(ComputeRoutesInternalData(from, {}, settled_vertices));
+                tree_cache_.Put(from, *tree, GetTreeBytes());
+            }
+            route_info = ReconstructRoute(**tree, to);
+        }
+        if (route_info) {
+            route_info->settled_vertices = settled_vertices;
+        }
+        return route_info;
+    }
+
+    template <typename Weight>
+    typename DijkstraRouter<Weight>::WeightsMatrix DijkstraRouter<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                                                             const std::vector<VertexId>& targets) const {
+        WeightsMatrix weights(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            size_t settled_vertices = 0;
+            const auto routes_internal_data = ComputeRoutesInternalData(sources[i], targets, settled_vertices);
+            for (size_t j = 0; j < targets.size(); ++j) {
+                if (const auto& route_internal_data = routes_internal_data.at(targets[j])) {
+                    weights[i][j] = route_internal_data->weight;
+                }
+            }
+        }
+        return weights;
+    }
+
+    template <typename Weight>
+    cache::Stats DijkstraRouter<Weight>::GetTreeCacheStats() const {
+        return tree_cache_.GetStats();
+    }
+
+    template <typename Weight>
+    typename DijkstraRouter<Weight>::RoutesInternalData
+    DijkstraRouter<Weight>::ComputeRoutesInternalData(VertexId from, const std::vector<VertexId>& targets,
+                                                      size_t& settled_vertices) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        RoutesInternalData routes_internal_data(vertex_count);
+        std::vector<bool> settled(vertex_count, false);
+        std::vector<bool> is_target(vertex_count, false);
+        size_t targets_left = 0;
+        for (const VertexId target : targets) {
+            if (!is_target.at(target)) {
+                is_target[target] = true;
+                ++targets_left;
+            }
+        }
+        Queue queue;
+
+        routes_internal_data.at(from) = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        queue.emplace(ZERO_WEIGHT, from);
+
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (settled[vertex]) {
+                continue;
+            }
+            settled[vertex] = true;
+            ++settled_vertices;
+            if (is_target[vertex] && --targets_left == 0) {
+                break;
+            }
+            const auto arcs = graph_.GetOutgoingArcs(vertex);
+            for (size_t arc = 0; arc < arcs.size; ++arc) {
+                const Weight candidate_weight = weight + arcs.weights[arc];
+                auto& route_relaxing = routes_internal_data[arcs.vertexes[arc]];
+                if (!route_relaxing || candidate_weight < route_relaxing->weight) {
+                    route_relaxing = RouteInternalData{candidate_weight, arcs.edge_ids[arc]};
+                    queue.emplace(candidate_weight, arcs.vertexes[arc]);
+                }
+            }
+        }
+        return routes_internal_data;
+    }
+
+    template <typename Weight>
+    std::optional<typename DijkstraRouter<Weight>::RouteInfo>
+    DijkstraRouter<Weight>::ReconstructRoute(const RoutesInternalData& routes_internal_data, VertexId to) const {
+        const auto& route_internal_data = routes_internal_data.at(to);
+        if (!route_internal_data) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
+             edge_id;
+             edge_id = routes_internal_data[graph_.GetEdge(*edge_id).from]->prev_edge)
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+
+        return RouteInfo{route_internal_data->weight, std::move(edges)};
+    }
+
+    template <typename Weight>
+    size_t DijkstraRouter<Weight>::GetTreeBytes() const {
+        return sizeof(RoutesInternalData) + graph_.GetVertexCount() * sizeof(typename RoutesInternalData::value_type);
+    }
+
+}  // namespace graph
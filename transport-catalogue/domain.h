@@ -1,12 +1,16 @@
 #pragma once
 
 #include "geo.h"
+#include "ranges.h"
 
-#include <deque>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
-#include <unordered_set>
 
 namespace TransportCatalogue {
 	namespace Info{
@@ -32,7 +36,9 @@ namespace TransportCatalogue {
 			public:
 				bool not_found = true;
 				std::string name;
-				std::vector<std::string_view> buses_on_stop;
+				//имена автобусов по алфавиту; память под ними держит storage, поэтому ответ переживает изменения справочника
+				ranges::Range<const std::string_view*> buses_on_stop = {nullptr, nullptr};
+				std::shared_ptr<const void> storage;
 			};
 
 			namespace Router{
@@ -47,9 +53,27 @@ namespace TransportCatalogue {
         			double time = 0.;
 				};
 
+				enum class RouterType {
+					ALL_PAIRS,
+					DIJKSTRA,
+					ASTAR,
+					BIDIRECTIONAL,
+					CONTRACTION_HIERARCHY,
+					RAPTOR
+				};
+
 				struct RoutingSettings {
 					double bus_velocity = 0.;
 					double bus_wait_time = 0.;
+					RouterType router_type = RouterType::ALL_PAIRS;
+					//бюджет памяти кэша деревьев кратчайших путей (для DIJKSTRA)
+					size_t tree_cache_bytes = 0;
+					//бюджет памяти кэша готовых ответов на запросы Route, 0 - без кэша
+					size_t route_cache_bytes = 0;
+					//число потоков предвычисления (для ALL_PAIRS), 0 - по числу ядер
+					size_t router_threads = 0;
+					//файл с предвычисленными данными маршрутизации (для ALL_PAIRS), пустая строка - без файла
+					std::string routing_data_file;
 				};
 			}
 
@@ -57,54 +81,47 @@ namespace TransportCatalogue {
 				bool not_found = true;
 				double total_time = 0.;
 				std::vector<std::variant<std::monostate, Router::BusRouteInfo, Router::WaitInfo>> items_;
+				//сколько вершин графа (для RAPTOR - остановок) обработал поиск; у ответа из кэша - поиск, который его нашёл
+				size_t settled_vertices = 0;
+				//число посадок в автобус минус одна
+				size_t transfer_count = 0;
+			};
+
+			struct ParetoRoutes {
+				//недоминируемые по времени и числу пересадок маршруты по возрастанию времени
+				std::vector<Route> routes;
+			};
+
+			struct Isochrone {
+				//достижимые остановки и время в пути до них по возрастанию времени
+				std::vector<std::pair<std::string_view, double>> stops;
+			};
+
+			struct Matrix {
+				//total_times[i][j] - время в пути из i-й начальной остановки в j-ю конечную, nullopt - маршрут не найден
+				std::vector<std::vector<std::optional<double>>> total_times;
 			};
 		}
 	
-		struct Bus;
-		
-		struct Stop{
-		
-			Stop() = default;
-		
-			explicit Stop(const std::string& name_stop,const Geo::Coordinates& stop_coordinates) : 
-																				name(name_stop),
-																				coordinates(stop_coordinates) {}
-			Stop(const std::string& name_stop) : name(name_stop) {}
-		
-			void ChangeCoordinates(const Geo::Coordinates& stop_coordinates) {
-				coordinates = stop_coordinates;
-			}
-		
-			bool operator==(Stop& other) {
-				return this->name == other.name;
-			}
-			
-		public:
-			std::string name;
-			Geo::Coordinates coordinates = {0,0};
-			//автобусы остановки
-			std::unordered_set<Bus*> buses_of_the_stop;
+		using StopId = std::uint32_t;
+		using BusId = std::uint32_t;
+
+		// Представление остановки: данные хранятся в массивах справочника по номеру остановки.
+		// Действительно до следующего изменения справочника
+		struct Stop {
+			StopId id = 0;
+			std::string_view name;
+			Geo::Coordinates coordinates = {0, 0};
+			//автобусы остановки по алфавиту
+			ranges::Range<const BusId*> buses_of_the_stop = {nullptr, nullptr};
 		};
-		
-		
-		
-		struct Bus{
-		
-			Bus() = default;
-			
-			Bus(const std::string& bus_name, bool is_roundtrip_) : name(bus_name)
-																 , is_roundtrip(is_roundtrip_) {
-			}
-		
-			bool operator==(const Bus& other) {
-				return this->name == other.name;
-			}
-			
-		
-		public:
-			std::string name;
-			//указатели на остановки автобуса
-			std::deque<Stop*> stops_of_the_bus;
+
+		// Представление автобуса поверх массивов справочника
+		struct Bus {
+			BusId id = 0;
+			std::string_view name;
+			//остановки автобуса
+			ranges::Range<const StopId*> stops_of_the_bus = {nullptr, nullptr};
 			bool is_roundtrip = false;
 		};
 }
@@ -2,7 +2,9 @@
 
 #include "ranges.h"
 
+#include <cassert>
 #include <cstdlib>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -22,43 +24,136 @@ namespace graph {
         Weight weight;
     };
     
+    // Дуги одной вершины в замороженном графе: соседние вершины, веса и номера рёбер лежат в параллельных массивах
+    template <typename Weight>
+    struct Arcs {
+        const VertexId* vertexes = nullptr;
+        const Weight* weights = nullptr;
+        const EdgeId* edge_ids = nullptr;
+        size_t size = 0;
+    };
+    
+    // После Freeze() граф неизменяем: списки смежности переносятся в сжатые массивы (CSR),
+    // и поиск проходит по исходящим и входящим дугам без обращения к отдельным векторам вершин.
+    // Входящие дуги нужны только поиску навстречу и строятся по запросу, чтобы не держать лишнюю копию рёбер.
     template <typename Weight>
     class DirectedWeightedGraph {
     private:
         using IncidenceList = std::vector<EdgeId>;
-        using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
+        using IncidentEdgesRange = ranges::Range<const EdgeId*>;
     
     public:
         DirectedWeightedGraph() = default;
         explicit DirectedWeightedGraph(size_t vertex_count);
         EdgeId AddEdge(const Edge<Weight>& edge);
+        void Freeze(bool with_incoming_arcs = false);
     
+        bool IsFrozen() const noexcept;
+        bool HasIncomingArcs() const noexcept;
         size_t GetVertexCount() const;
         size_t GetEdgeCount() const;
-        const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+        // Номер ребра не проверяется
+        const Edge<Weight>& GetEdge(EdgeId edge_id) const noexcept;
         IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
+
+        // Только для замороженного графа, номер вершины не проверяется
+        Arcs<Weight> GetOutgoingArcs(VertexId vertex) const noexcept;
+        // Только для графа, замороженного с входящими дугами
+        Arcs<Weight> GetIncomingArcs(VertexId vertex) const noexcept;
     
     private:
+        struct CompressedArcs {
+            //дуги вершины v занимают позиции [offsets[v], offsets[v + 1])
+            std::vector<size_t> offsets;
+            std::vector<VertexId> vertexes;
+            std::vector<Weight> weights;
+            std::vector<EdgeId> edge_ids;
+        };
+
+        // by_source: группировать рёбра по началу (исходящие дуги) или по концу (входящие)
+        CompressedArcs CompressArcs(bool by_source) const;
+        static Arcs<Weight> GetArcs(const CompressedArcs& arcs, VertexId vertex) noexcept;
+
+        size_t vertex_count_ = 0;
         std::vector<Edge<Weight>> edges_;
         std::vector<IncidenceList> incidence_lists_;
+        bool is_frozen_ = false;
+        bool has_incoming_arcs_ = false;
+        CompressedArcs outgoing_arcs_;
+        CompressedArcs incoming_arcs_;
     };
     
     template <typename Weight>
     DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
-        : incidence_lists_(vertex_count) {
+        : vertex_count_(vertex_count)
+        , incidence_lists_(vertex_count) {
     }
     
     template <typename Weight>
     EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+        if (is_frozen_) {
+            throw std::logic_error("Graph is frozen");
+        }
         edges_.push_back(edge);
         const EdgeId id = edges_.size() - 1;
         incidence_lists_.at(edge.from).push_back(id);
         return id;
     }
+
+    template <typename Weight>
+    void DirectedWeightedGraph<Weight>::Freeze(bool with_incoming_arcs) {
+        if (with_incoming_arcs && !has_incoming_arcs_) {
+            incoming_arcs_ = CompressArcs(false);
+            has_incoming_arcs_ = true;
+        }
+        if (is_frozen_) {
+            return;
+        }
+        outgoing_arcs_ = CompressArcs(true);
+        incidence_lists_.clear();
+        incidence_lists_.shrink_to_fit();
+        is_frozen_ = true;
+    }
+
+    template <typename Weight>
+    typename DirectedWeightedGraph<Weight>::CompressedArcs DirectedWeightedGraph<Weight>::CompressArcs(bool by_source) const {
+        CompressedArcs result;
+        result.offsets.assign(vertex_count_ + 1, 0);
+        for (const auto& edge : edges_) {
+            ++result.offsets[(by_source ? edge.from : edge.to) + 1];
+        }
+        for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+            result.offsets[vertex + 1] += result.offsets[vertex];
+        }
+        result.vertexes.resize(edges_.size());
+        result.weights.resize(edges_.size());
+        result.edge_ids.resize(edges_.size());
+
+        // рёбра раскладываются по возрастанию номера, поэтому порядок дуг вершины совпадает с порядком добавления
+        std::vector<size_t> positions(result.offsets.begin(), result.offsets.end() - 1);
+        for (EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+            const auto& edge = edges_[edge_id];
+            const size_t position = positions[by_source ? edge.from : edge.to]++;
+            result.vertexes[position] = by_source ? edge.to : edge.from;
+            result.weights[position] = edge.weight;
+            result.edge_ids[position] = edge_id;
+        }
+        return result;
+    }
+
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::IsFrozen() const noexcept {
+        return is_frozen_;
+    }
     
+    template <typename Weight>
+    bool DirectedWeightedGraph<Weight>::HasIncomingArcs() const noexcept {
+        return has_incoming_arcs_;
+    }
+
     template <typename Weight>
     size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
-        return incidence_lists_.size();
+        return vertex_count_;
     }
     
     template <typename Weight>
@@ -67,13 +162,37 @@ namespace graph {
     }
     
     template <typename Weight>
-    const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
-        return edges_.at(edge_id);
+    const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const noexcept {
+        assert(edge_id < edges_.size());
+        return edges_[edge_id];
     }
     
     template <typename Weight>
     typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
     DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
-        return ranges::AsRange(incidence_lists_.at(vertex));
+        if (is_frozen_) {
+            const auto arcs = GetOutgoingArcs(vertex);
+            return IncidentEdgesRange{arcs.edge_ids, arcs.edge_ids + arcs.size};
+        }
+        const auto& incidence_list = incidence_lists_.at(vertex);
+        return IncidentEdgesRange{incidence_list.data(), incidence_list.data() + incidence_list.size()};
+    }
+
+    template <typename Weight>
+    Arcs<Weight> DirectedWeightedGraph<Weight>::GetOutgoingArcs(VertexId vertex) const noexcept {
+        return GetArcs(outgoing_arcs_, vertex);
+    }
+
+    template <typename Weight>
+    Arcs<Weight> DirectedWeightedGraph<Weight>::GetIncomingArcs(VertexId vertex) const noexcept {
+        assert(has_incoming_arcs_);
+        return GetArcs(incoming_arcs_, vertex);
+    }
+
+    template <typename Weight>
+    Arcs<Weight> DirectedWeightedGraph<Weight>::GetArcs(const CompressedArcs& arcs, VertexId vertex) noexcept {
+        const size_t begin = arcs.offsets[vertex];
+        return Arcs<Weight>{arcs.vertexes.data() + begin, arcs.weights.data() + begin,
+                            arcs.edge_ids.data() + begin, arcs.offsets[vertex + 1] - begin};
     }
 }  // namespace graph
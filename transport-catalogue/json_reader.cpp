@@ -1,5 +1,10 @@
 #include "json_reader.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
 namespace TransportCatalogue {
     namespace Input {
         using namespace std::literals;
@@ -23,7 +28,31 @@ namespace TransportCatalogue {
                     rh.AddStatRequest(request_id, std::move(request_type), std::move(request_name));
                 } else if (request_type == "Route"s) {
                     std::pair<std::string, std::string> stop_from_to = {request.at("from"s).AsString(), request.at("to"s).AsString()};
-                    rh.AddStatRequest(request_id, std::move(request_type), stop_from_to);
+                    //без ограничения пересадок и без pareto это обычный запрос маршрута
+                    if ((request.count("pareto"s) && request.at("pareto"s).AsBool()) || request.count("max_transfers"s)) {
+                        RequestHandler::RouteOptions options;
+                        options.stops = std::move(stop_from_to);
+                        if (request.count("pareto"s)) {
+                            options.pareto = request.at("pareto"s).AsBool();
+                        }
+                        if (request.count("max_transfers"s)) {
+                            const int max_transfers = request.at("max_transfers"s).AsInt();
+                            if (max_transfers < 0) {
+                                throw std::invalid_argument("max_transfers should be non-negative"s);
+                            }
+                            options.max_transfers = static_cast<size_t>(max_transfers);
+                        }
+                        rh.AddStatRequest(request_id, std::move(request_type), std::move(options));
+                    } else {
+                        rh.AddStatRequest(request_id, std::move(request_type), stop_from_to);
+                    }
+                } else if (request_type == "Matrix"s) {
+                    std::pair<std::vector<std::string>, std::vector<std::string>> stops_from_to = {GetStopNamesFromJson(request.at("sources"s)),
+                                                                                                   GetStopNamesFromJson(request.at("targets"s))};
+                    rh.AddStatRequest(request_id, std::move(request_type), std::move(stops_from_to));
+                } else if (request_type == "Isochrone"s) {
+                    std::pair<std::string, double> stop_from_max_time = {request.at("from"s).AsString(), request.at("max_time"s).AsDouble()};
+                    rh.AddStatRequest(request_id, std::move(request_type), std::move(stop_from_max_time));
                 } else if (request_type == "Map"s) {
                     rh.AddStatRequest(request_id, std::move(request_type), ""s);
                 }
@@ -33,38 +62,41 @@ namespace TransportCatalogue {
         
 
         void JsonReader::LoadBaseRequests(TransportCatalogue &catalogue) const {
-            std::unordered_map<std::string, JSON::Dict> length_between_stops;
-            std::unordered_map<std::string, std::pair<JSON::Array, bool>> buses;
-            auto requests = input_.GetRoot().AsDict();
-            auto base_requests_ = requests.at("base_requests"s).AsArray();
+            //имена в запросах ссылаются на строки документа
+            BaseRequests base_requests;
+            const auto& requests = input_.GetRoot().AsDict();
             
-            for (auto&& base_request : base_requests_) {
-                auto request = base_request.AsDict();
-                std::string request_type = request.at("type"s).AsString();
+            for (const auto& base_request : requests.at("base_requests"s).AsArray()) {
+                const auto& request = base_request.AsDict();
+                const auto& request_type = request.at("type"s).AsString();
                 
                 if (request_type == "Stop"s) {
-                    auto stop_name = request.at("name"s).AsString();
+                    const auto& stop_name = request.at("name"s).AsString();
                     Geo::Coordinates coordinates = {request.at("latitude"s).AsDouble(), request.at("longitude"s).AsDouble()};
-                    catalogue.AddStop(stop_name, coordinates);
-                    length_between_stops[stop_name] = request.at("road_distances"s).AsDict();
+                    base_requests.stops.push_back({stop_name, coordinates});
+                    for (const auto& [stop_to, length] : request.at("road_distances"s).AsDict()) {
+                        base_requests.distances.push_back({stop_name, stop_to, length.AsDouble()});
+                    }
                 
                 } else if (request_type == "Bus"s) {
-                    bool is_roundtrip = request.at("is_roundtrip").AsBool();
-                    std::string bus_name = request.at("name").AsString();
-            
-                    if (is_roundtrip) {
-                        buses[bus_name] = {request.at("stops"s).AsArray(), is_roundtrip};
-                    
-                    } else if (!is_roundtrip) {
-                        auto stops = request.at("stops"s).AsArray();
-                        stops.reserve(stops.size() * 2);
-                        stops.insert(stops.end(), ++stops.rbegin(), stops.rend());
-                        buses[bus_name] = {std::move(stops), is_roundtrip};
-                    } 
+                    BusRequest bus;
+                    bus.name = request.at("name"s).AsString();
+                    bus.is_roundtrip = request.at("is_roundtrip"s).AsBool();
+                    const auto& stops = request.at("stops"s).AsArray();
+                    bus.stops.reserve(stops.size() * 2);
+                    for (const auto& stop : stops) {
+                        bus.stops.push_back(stop.AsString());
+                    }
+                    //некольцевой автобус идёт обратно тем же путём
+                    if (!bus.is_roundtrip && !stops.empty()) {
+                        for (size_t i = stops.size() - 1; i > 0; --i) {
+                            bus.stops.push_back(bus.stops[i - 1]);
+                        }
+                    }
+                    base_requests.buses.push_back(std::move(bus));
                 }
             }
-            LoadStopsDistances(std::move(length_between_stops), catalogue);
-            LoadBuses(std::move(buses), catalogue);
+            catalogue.AddBaseRequests(base_requests);
         }
 
 
@@ -100,6 +132,21 @@ namespace TransportCatalogue {
             Info::Router::RoutingSettings result;
             result.bus_velocity = routing_settings_dict.at("bus_velocity"s).AsDouble();
             result.bus_wait_time = routing_settings_dict.at("bus_wait_time"s).AsDouble();
+            if (routing_settings_dict.count("router"s)) {
+                result.router_type = GetRouterTypeFromJson(routing_settings_dict.at("router"s));
+            }
+            if (routing_settings_dict.count("router_threads"s)) {
+                result.router_threads = GetThreadCountFromJson(routing_settings_dict.at("router_threads"s));
+            }
+            if (routing_settings_dict.count("tree_cache_mb"s)) {
+                result.tree_cache_bytes = GetCacheBytesFromJson(routing_settings_dict.at("tree_cache_mb"s));
+            }
+            if (routing_settings_dict.count("route_cache_mb"s)) {
+                result.route_cache_bytes = GetCacheBytesFromJson(routing_settings_dict.at("route_cache_mb"s));
+            }
+            if (routing_settings_dict.count("routing_data_file"s)) {
+                result.routing_data_file = routing_settings_dict.at("routing_data_file"s).AsString();
+            }
             router.SetSettings(result);
         }
 
@@ -114,6 +161,12 @@ namespace TransportCatalogue {
                     result.Value(PackStopInfoIntoJsonDict(id, info));
                 } else if (std::holds_alternative<Info::Route>(info)) {
                     result.Value(PackRouteInfoIntoJsonDict(id, info));
+                } else if (std::holds_alternative<Info::Matrix>(info)) {
+                    result.Value(PackMatrixInfoIntoJsonDict(id, info));
+                } else if (std::holds_alternative<Info::ParetoRoutes>(info)) {
+                    result.Value(PackParetoRoutesInfoIntoJsonDict(id, info));
+                } else if (std::holds_alternative<Info::Isochrone>(info)) {
+                    result.Value(PackIsochroneInfoIntoJsonDict(id, info));
                 } else if (std::holds_alternative<std::string>(info)) {
                     result.Value(PackMapInfoIntoJsonDict(id,info));
                 }
@@ -124,29 +177,6 @@ namespace TransportCatalogue {
     }
 
 
-    void Input::JsonReader::LoadStopsDistances(const std::unordered_map<std::string,JSON::Dict>& stops, TransportCatalogue& catalogue) {
-        for (const auto& [stop1_name, length_to_stops] : stops) {
-            for (const auto& [stop2_name, length] : length_to_stops) {
-                catalogue.SetDistanceBetweenStops(stop1_name, stop2_name, length.AsDouble());
-            }
-        }
-    }
-
-
-    void Input::JsonReader::LoadBuses(const std::unordered_map<std::string, std::pair<JSON::Array, bool>>& buses, TransportCatalogue& catalogue) {
-        for (const auto& [bus_name, stops_and_bool] : buses) {
-            const auto& [stops, is_roundtrip] = stops_and_bool;
-            std::vector<std::string_view> stops_of_the_bus_view;
-            stops_of_the_bus_view.reserve(stops.size());
-            
-            for(const auto& stop : stops) {
-                stops_of_the_bus_view.emplace_back(stop.AsString());
-            }
-            catalogue.AddBus(bus_name, std::move(stops_of_the_bus_view), is_roundtrip);
-        }
-    }
-
-
     svg::Color Input::JsonReader::GetColorFromJson(const JSON::Node& node) {
         if (node.IsArray()) {
             std::vector<double> vec;
@@ -166,6 +196,51 @@ namespace TransportCatalogue {
     }
 
 
+    std::vector<std::string> Input::JsonReader::GetStopNamesFromJson(const JSON::Node& node) {
+        std::vector<std::string> result;
+        for (const auto& stop : node.AsArray()) {
+            result.emplace_back(stop.AsString());
+        }
+        return result;
+    }
+
+
+    Info::Router::RouterType Input::JsonReader::GetRouterTypeFromJson(const JSON::Node& node) {
+        const auto& router_type = node.AsString();
+        if (router_type == "all_pairs"s) {
+            return Info::Router::RouterType::ALL_PAIRS;
+        } else if (router_type == "dijkstra"s) {
+            return Info::Router::RouterType::DIJKSTRA;
+        } else if (router_type == "astar"s) {
+            return Info::Router::RouterType::ASTAR;
+        } else if (router_type == "bidirectional"s) {
+            return Info::Router::RouterType::BIDIRECTIONAL;
+        } else if (router_type == "contraction_hierarchy"s) {
+            return Info::Router::RouterType::CONTRACTION_HIERARCHY;
+        } else if (router_type == "raptor"s) {
+            return Info::Router::RouterType::RAPTOR;
+        }
+        throw std::invalid_argument("Router type isn't correct"s);
+    }
+
+    size_t Input::JsonReader::GetCacheBytesFromJson(const JSON::Node& node) {
+        const double bytes = node.AsDouble() * BYTES_IN_MEGABYTE;
+        //граница сравнивается в double: max size_t в double округляется вверх и уже не помещается в size_t
+        if (!std::isfinite(bytes) || bytes < 0. || bytes >= static_cast<double>(std::numeric_limits<size_t>::max())) {
+            throw std::invalid_argument("Cache size should be a non-negative number of megabytes"s);
+        }
+        return static_cast<size_t>(bytes);
+    }
+
+    size_t Input::JsonReader::GetThreadCountFromJson(const JSON::Node& node) {
+        const int thread_count = node.AsInt();
+        if (thread_count < 0) {
+            throw std::invalid_argument("Router threads should be a non-negative number"s);
+        }
+        return std::min(static_cast<size_t>(thread_count), MAX_ROUTER_THREADS);
+    }
+
+
     JSON::Dict Input::JsonReader::PackBusInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info) {
         JSON::Builder result;
         result.StartDict().Key("request_id"s).Value(id);
@@ -185,7 +260,7 @@ namespace TransportCatalogue {
     JSON::Dict Input::JsonReader::PackStopInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info) {
         JSON::Builder result;
         result.StartDict().Key("request_id"s).Value(id);
-        auto stop_info = std::get<Info::Stop>(info);          
+        const auto& stop_info = std::get<Info::Stop>(info);
         if (stop_info.not_found) {
             result.Key("error_message"s).Value("not found"s);
         } else {
@@ -216,28 +291,81 @@ namespace TransportCatalogue {
             result.Key("error_message"s).Value("not found"s);
         } else {
             result.Key("total_time"s).Value(route_info.total_time)
-                  .Key("items"s).StartArray();
-            for (const auto& item : route_info.items_) {
-                result.StartDict();
-                if(std::holds_alternative<Info::Router::BusRouteInfo>(item)) {
-                    auto bus_route_info = std::get<Info::Router::BusRouteInfo>(item);
-                    result.Key("type"s).Value("Bus"s)
-                          .Key("bus"s).Value(std::string(bus_route_info.bus_name))
-                          .Key("span_count"s).Value(bus_route_info.span_count)
-                          .Key("time"s).Value(bus_route_info.time);
-                } else {
-                    auto wait_info = std::get<Info::Router::WaitInfo>(item);
-                    result.Key("type"s).Value("Wait"s)
-                          .Key("stop_name"s).Value(std::string(wait_info.stop_name))
-                          .Key("time"s).Value(wait_info.time);
-                }
-                result.EndDict();
+                  .Key("items"s).Value(PackRouteItemsIntoJsonArray(route_info));
+        }
+        return result.EndDict().Build().AsDict();
+    }
+
+    JSON::Dict Input::JsonReader::PackParetoRoutesInfoIntoJsonDict(int id, const RequestHandler::RequestInfo &info) {
+        JSON::Builder result;
+        result.StartDict().Key("request_id").Value(id);
+        const auto& routes = std::get<Info::ParetoRoutes>(info).routes;
+        if (routes.empty()) {
+            result.Key("error_message"s).Value("not found"s);
+        } else {
+            result.Key("routes"s).StartArray();
+            for (const auto& route_info : routes) {
+                result.StartDict()
+                      .Key("total_time"s).Value(route_info.total_time)
+                      .Key("transfer_count"s).Value(static_cast<int>(route_info.transfer_count))
+                      .Key("items"s).Value(PackRouteItemsIntoJsonArray(route_info))
+                      .EndDict();
             }
             result.EndArray();
         }
         return result.EndDict().Build().AsDict();
     }
-}
 
+    JSON::Array Input::JsonReader::PackRouteItemsIntoJsonArray(const Info::Route& route_info) {
+        JSON::Builder result;
+        result.StartArray();
+        for (const auto& item : route_info.items_) {
+            result.StartDict();
+            if(std::holds_alternative<Info::Router::BusRouteInfo>(item)) {
+                auto bus_route_info = std::get<Info::Router::BusRouteInfo>(item);
+                result.Key("type"s).Value("Bus"s)
+                      .Key("bus"s).Value(std::string(bus_route_info.bus_name))
+                      .Key("span_count"s).Value(bus_route_info.span_count)
+                      .Key("time"s).Value(bus_route_info.time);
+            } else {
+                auto wait_info = std::get<Info::Router::WaitInfo>(item);
+                result.Key("type"s).Value("Wait"s)
+                      .Key("stop_name"s).Value(std::string(wait_info.stop_name))
+                      .Key("time"s).Value(wait_info.time);
+            }
+            result.EndDict();
+        }
+        return result.EndArray().Build().AsArray();
+    }
 
+    JSON::Dict Input::JsonReader::PackMatrixInfoIntoJsonDict(int id, const RequestHandler::RequestInfo &info) {
+        JSON::Builder result;
+        result.StartDict().Key("request_id").Value(id)
+              .Key("total_times"s).StartArray();
+        for (const auto& row : std::get<Info::Matrix>(info).total_times) {
+            result.StartArray();
+            for (const auto& total_time : row) {
+                if (total_time) {
+                    result.Value(*total_time);
+                } else {
+                    result.Value(nullptr);
+                }
+            }
+            result.EndArray();
+        }
+        return result.EndArray().EndDict().Build().AsDict();
+    }
 
+    JSON::Dict Input::JsonReader::PackIsochroneInfoIntoJsonDict(int id, const RequestHandler::RequestInfo &info) {
+        JSON::Builder result;
+        result.StartDict().Key("request_id").Value(id)
+              .Key("stops"s).StartArray();
+        for (const auto& [stop_name, time] : std::get<Info::Isochrone>(info).stops) {
+            result.StartDict()
+                  .Key("stop_name"s).Value(std::string(stop_name))
+                  .Key("time"s).Value(time)
+                  .EndDict();
+        }
+        return result.EndArray().EndDict().Build().AsDict();
+    }
+}
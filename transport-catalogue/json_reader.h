@@ -12,6 +12,10 @@ namespace TransportCatalogue {
 
     namespace Input {
 
+        const double BYTES_IN_MEGABYTE = 1024. * 1024.;
+        //больше потоков предвычисления не ускоряет Флойда-Уоршелла, а только тратит память на стеки
+        const size_t MAX_ROUTER_THREADS = 256;
+
         class JsonReader {
         public:
             
@@ -26,13 +30,21 @@ namespace TransportCatalogue {
             void PrintStatRequests(RequestHandler::RequestHandler& rh, std::ostream& out);
             
         private:
-            static void LoadStopsDistances(const std::unordered_map<std::string,JSON::Dict>& stops, TransportCatalogue& catalogue);
-            static void LoadBuses(const std::unordered_map<std::string, std::pair<JSON::Array, bool>>& buses, TransportCatalogue& catalogue);
             static svg::Color GetColorFromJson(const JSON::Node& node);
+            static Info::Router::RouterType GetRouterTypeFromJson(const JSON::Node& node);
+            // Объём кэша в мегабайтах -> байты; бросает invalid_argument для отрицательных, NaN и слишком больших значений
+            static size_t GetCacheBytesFromJson(const JSON::Node& node);
+            // Число потоков не больше MAX_ROUTER_THREADS; бросает invalid_argument для отрицательных значений
+            static size_t GetThreadCountFromJson(const JSON::Node& node);
             static JSON::Dict PackBusInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
             static JSON::Dict PackStopInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
             static JSON::Dict PackMapInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
             static JSON::Dict PackRouteInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
+            static JSON::Dict PackMatrixInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
+            static JSON::Dict PackParetoRoutesInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
+            static JSON::Dict PackIsochroneInfoIntoJsonDict(int id, const RequestHandler::RequestInfo& info);
+            static JSON::Array PackRouteItemsIntoJsonArray(const Info::Route& route_info);
+            static std::vector<std::string> GetStopNamesFromJson(const JSON::Node& node);
 
             JSON::Document input_;
             JSON::Document print_info_;
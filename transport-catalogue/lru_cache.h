@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace cache {
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t used_bytes = 0;
+        size_t capacity_bytes = 0;
+    };
+
+    // Кэш с вытеснением давно не использованных записей (LRU) и ограничением по памяти.
+    // Размер каждой записи в байтах передаёт вызывающая сторона.
+    // Все методы потокобезопасны.
+    template <typename Key, typename Value, typename Hash = std::hash<Key>>
+    class LruCache {
+    public:
+        explicit LruCache(size_t capacity_bytes = 0);
+
+        std::optional<Value> Get(const Key& key);
+        void Put(const Key& key, Value value, size_t bytes);
+        void Clear();
+
+        Stats GetStats() const;
+
+    private:
+        struct Entry {
+            Key key;
+            Value value;
+            size_t bytes = 0;
+        };
+        using Entries = std::list<Entry>;
+
+        void Erase(typename Entries::iterator it);
+
+        mutable std::mutex mutex_;
+        //в начале списка - самые свежие записи
+        Entries entries_;
+        std::unordered_map<Key, typename Entries::iterator, Hash> key_to_entry_;
+        Stats stats_;
+    };
+
+    template <typename Key, typename Value, typename Hash>
+    LruCache<Key, Value, Hash>::LruCache(size_t capacity_bytes) {
+        stats_.capacity_bytes = capacity_bytes;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    std::optional<Value> LruCache<Key, Value, Hash>::Get(const Key& key) {
+        std::lock_guard guard(mutex_);
+        auto pos = key_to_entry_.find(key);
+        if (pos == key_to_entry_.end()) {
+            ++stats_.misses;
+            return std::nullopt;
+        }
+        ++stats_.hits;
+        entries_.splice(entries_.begin(), entries_, pos->second);
+        return pos->second->value;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LruCache<Key, Value, Hash>::Put(const Key& key, Value value, size_t bytes) {
+        std::lock_guard guard(mutex_);
+        if (auto pos = key_to_entry_.find(key); pos != key_to_entry_.end()) {
+            Erase(pos->second);
+        }
+        if (bytes > stats_.capacity_bytes) {
+            return;
+        }
+        while (stats_.used_bytes + bytes > stats_.capacity_bytes) {
+            Erase(std::prev(entries_.end()));
+            ++stats_.evictions;
+        }
+        entries_.push_front(Entry{key, std::move(value), bytes});
+        key_to_entry_[key] = entries_.begin();
+        stats_.used_bytes += bytes;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LruCache<Key, Value, Hash>::Clear() {
+        std::lock_guard guard(mutex_);
+        entries_.clear();
+        key_to_entry_.clear();
+        stats_.used_bytes = 0;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    Stats LruCache<Key, Value, Hash>::GetStats() const {
+        std::lock_guard guard(mutex_);
+        return stats_;
+    }
+
+    template <typename Key, typename Value, typename Hash>
+    void LruCache<Key, Value, Hash>::Erase(typename Entries::iterator it) {
+        stats_.used_bytes -= it->bytes;
+        key_to_entry_.erase(it->key);
+        entries_.erase(it);
+    }
+
+}  // namespace cache
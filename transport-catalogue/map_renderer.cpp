@@ -3,28 +3,43 @@
 namespace MapRenderer {
     using namespace std::literals;
     
-    void MapRenderer::UpdateRendererMap(const std::unordered_map<std::string_view, TransportCatalogue::Bus *>& buses, 
-                                        const std::unordered_map<std::string_view, TransportCatalogue::Stop *>& stops) {
+    void MapRenderer::UpdateRendererMap(const TransportCatalogue::TransportCatalogue& catalogue) {
+        if (catalogue_ == &catalogue) {
+            if (catalogue_version_ == catalogue.GetVersion()) {
+                return;
+            }
+            //расстояний на карте нет, карту меняют только остановки и автобусы
+            const auto changes = catalogue.GetChangesSince(catalogue_version_);
+            if (changes && std::all_of(changes->begin(), changes->end(), [](const TransportCatalogue::CatalogueChange& change) {
+                    return change.type == TransportCatalogue::CatalogueChange::Type::DISTANCE_SET;
+                })) {
+                catalogue_version_ = catalogue.GetVersion();
+                return;
+            }
+        }
+        catalogue_ = &catalogue;
+        catalogue_version_ = catalogue.GetVersion();
+        rendered_map_.reset();
         {
-            auto pos_begin = buses.begin();
-            auto pos_end = buses.end();
-            buses_.reserve(buses.size());
-            for (;pos_begin != pos_end;++pos_begin) {
-                buses_.emplace_back(pos_begin->second);
+            buses_.clear();
+            buses_.reserve(catalogue.GetBusCount());
+            for (TransportCatalogue::BusId bus = 0; bus < catalogue.GetBusCount(); ++bus) {
+                if (!catalogue.IsBusRemoved(bus)) {
+                    buses_.emplace_back(catalogue.GetBus(bus));
+                }
             }
-            std::sort(buses_.begin(), buses_.end(), [](TransportCatalogue::Bus* lhs, TransportCatalogue::Bus* rhs) {
-                return lhs->name < rhs->name;
+            std::sort(buses_.begin(), buses_.end(), [](const TransportCatalogue::Bus& lhs, const TransportCatalogue::Bus& rhs) {
+                return lhs.name < rhs.name;
             });
         }
         {
-            auto pos_begin = stops.begin();
-            auto pos_end = stops.end();
-            stops_.reserve(stops_.size());
-            for (;pos_begin != pos_end;++pos_begin) {
-                stops_.emplace_back(pos_begin->second);
+            stops_.clear();
+            stops_.reserve(catalogue.GetStopCount());
+            for (TransportCatalogue::StopId stop = 0; stop < catalogue.GetStopCount(); ++stop) {
+                stops_.emplace_back(catalogue.GetStop(stop));
             }
-            std::sort(stops_.begin(), stops_.end(), [](TransportCatalogue::Stop* lhs, TransportCatalogue::Stop* rhs) {
-                return lhs->name < rhs->name;
+            std::sort(stops_.begin(), stops_.end(), [](const TransportCatalogue::Stop& lhs, const TransportCatalogue::Stop& rhs) {
+                return lhs.name < rhs.name;
             });
         }
 
@@ -38,30 +53,30 @@ namespace MapRenderer {
             .SetStrokeWidth(render_settings_.line_width);
     }
 
-    void MapRenderer::SetBusNameTextSettings(svg::Text &text, TransportCatalogue::Bus* bus_ptr) const {        
+    void MapRenderer::SetBusNameTextSettings(svg::Text &text, const TransportCatalogue::Bus& bus) const {        
         svg::Point label_ofset = {render_settings_.bus_label_offset[0], render_settings_.bus_label_offset[1]};
         text.SetOffset(label_ofset)
             .SetFontSize(render_settings_.bus_label_font_size)
             .SetFontFamily("Verdana"s)
             .SetFontWeight("bold"s)
-            .SetData(bus_ptr->name);       
+            .SetData(std::string(bus.name));       
     }
 
-    void MapRenderer::SetStopNameTextSettings(svg::Text &text, TransportCatalogue::Stop* stop_ptr) const {
+    void MapRenderer::SetStopNameTextSettings(svg::Text &text, const TransportCatalogue::Stop& stop) const {
         svg::Point stop_label_ofset = {render_settings_.stop_label_offset[0], render_settings_.stop_label_offset[1]};
         text.SetOffset(stop_label_ofset)
             .SetFontSize(render_settings_.stop_label_font_size)
             .SetFontFamily("Verdana"s)
-            .SetData(stop_ptr->name);
+            .SetData(std::string(stop.name));
     }
 
     SphereProjector MapRenderer::MakeSpereProjector() const {
         std::vector<Geo::Coordinates> coordinates;
         coordinates.reserve(stops_.size());
         
-        for (const auto& stop_ptr : stops_){
-            if(!stop_ptr->buses_of_the_stop.empty()) {
-                coordinates.emplace_back(stop_ptr->coordinates);
+        for (const auto& stop : stops_){
+            if(!stop.buses_of_the_stop.empty()) {
+                coordinates.emplace_back(stop.coordinates);
             }
         }
         return  SphereProjector(coordinates.begin(), coordinates.end(),
@@ -79,15 +94,15 @@ namespace MapRenderer {
     void MapRenderer::DrawBusLine(const SphereProjector& sphere_projector) {
         render_settings_.number_of_current_color = 0;
         
-        for (const auto& bus_ptr : buses_) {    
+        for (const auto& bus : buses_) {    
             SetRightColor();
             svg::Polyline line;
             
-            for (const auto& stop : bus_ptr->stops_of_the_bus){
-                line.AddPoint(sphere_projector(stop->coordinates));
+            for (const auto stop : bus.stops_of_the_bus){
+                line.AddPoint(sphere_projector(catalogue_->GetStop(stop).coordinates));
             }
             
-            if (!bus_ptr->stops_of_the_bus.empty()){
+            if (!bus.stops_of_the_bus.empty()){
                 SetBusLineSettings(line);
             }
             document_.Add(line);
@@ -99,11 +114,11 @@ namespace MapRenderer {
 
     void MapRenderer::DrawBusName(const SphereProjector &sphere_projector) {
         render_settings_.number_of_current_color = 0;
-        for (const auto& bus_ptr : buses_) { 
+        for (const auto& bus : buses_) { 
             SetRightColor();
             svg::Text underlayer;
             svg::Text bus_name_text;
-            auto stops = bus_ptr->stops_of_the_bus;
+            auto stops = bus.stops_of_the_bus;
             
             underlayer.SetFillColor(render_settings_.underlayer_color)
                     .SetStrokeColor(render_settings_.underlayer_color)
@@ -113,22 +128,22 @@ namespace MapRenderer {
 
             bus_name_text.SetFillColor(render_settings_.color_palette[render_settings_.number_of_current_color]);
             
-            SetBusNameTextSettings(underlayer, bus_ptr);
-            SetBusNameTextSettings(bus_name_text, bus_ptr);
+            SetBusNameTextSettings(underlayer, bus);
+            SetBusNameTextSettings(bus_name_text, bus);
 
             auto first_stop = stops.front();
-            auto point = sphere_projector(first_stop->coordinates);
+            auto point = sphere_projector(catalogue_->GetStop(first_stop).coordinates);
             underlayer.SetPosition(point);
             bus_name_text.SetPosition(point);
             document_.Add(underlayer);
             document_.Add(bus_name_text);
                 
-            if (!bus_ptr->is_roundtrip) {
+            if (!bus.is_roundtrip) {
                 int pos_of_last_stop = stops.size() / 2;
                 auto last_stop = stops[pos_of_last_stop];
                 
                 if (last_stop != first_stop) {
-                    auto point = sphere_projector(last_stop->coordinates);
+                    auto point = sphere_projector(catalogue_->GetStop(last_stop).coordinates);
                     underlayer.SetPosition(point);
                     bus_name_text.SetPosition(point);
                     document_.Add(underlayer);
@@ -143,9 +158,9 @@ namespace MapRenderer {
     void MapRenderer::DrawStopCircles(const SphereProjector &sphere_projector) {
         for (const auto& stop : stops_) { 
             
-            if(!stop->buses_of_the_stop.empty()){       
+            if(!stop.buses_of_the_stop.empty()){       
                 svg::Circle stop_circle;
-                stop_circle.SetCenter(sphere_projector(stop->coordinates));
+                stop_circle.SetCenter(sphere_projector(stop.coordinates));
                 stop_circle.SetRadius(render_settings_.stop_radius);
                 stop_circle.SetFillColor("white"s);
                 document_.Add(stop_circle);
@@ -156,10 +171,10 @@ namespace MapRenderer {
 
     void MapRenderer::DrawStopNames(const SphereProjector &sphere_projector) {
         for (const auto& stop : stops_) { 
-            if(!stop->buses_of_the_stop.empty()){       
+            if(!stop.buses_of_the_stop.empty()){       
                 svg::Text stop_name_text;
                 svg::Text underlayer;
-                svg::Point point = sphere_projector(stop->coordinates);
+                svg::Point point = sphere_projector(stop.coordinates);
                 
                 stop_name_text.SetPosition(point)
                               .SetFillColor("black"s);
@@ -182,20 +197,29 @@ namespace MapRenderer {
     }
 
     void MapRenderer::RenderMap(std::ostream &out) {
-        bool is_empty = render_settings_.color_palette.empty() || buses_.empty() || stops_.empty();
-        if(!is_empty){
-            SphereProjector sphere_projector = MakeSpereProjector();
-            DrawBusLine(sphere_projector);
-            DrawBusName(sphere_projector);
-            DrawStopCircles(sphere_projector);
-            DrawStopNames(sphere_projector);
+        if (catalogue_) {
+            UpdateRendererMap(*catalogue_);
         }
-        
-        document_.Render(out);
+        if (!rendered_map_) {
+            document_.Clear();
+            bool is_empty = render_settings_.color_palette.empty() || buses_.empty() || stops_.empty();
+            if(!is_empty){
+                SphereProjector sphere_projector = MakeSpereProjector();
+                DrawBusLine(sphere_projector);
+                DrawBusName(sphere_projector);
+                DrawStopCircles(sphere_projector);
+                DrawStopNames(sphere_projector);
+            }
+            std::ostringstream map;
+            document_.Render(map);
+            rendered_map_ = map.str();
+        }
+        out << *rendered_map_;
     }
 
     void MapRenderer::SetRenderSettings(RenderSettings&& render_settings) {
         render_settings_ = std::move(render_settings);
+        rendered_map_.reset();
     }
 
     bool SphereProjector::IsZero(double value){
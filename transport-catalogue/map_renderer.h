@@ -1,10 +1,14 @@
 #pragma once
 
 #include "domain.h"
+#include "transport_catalogue.h"
 #include "geo.h"
 #include "svg.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <sstream>
 #include <unordered_set>
 #include <string>
 #include <vector>
@@ -104,9 +108,11 @@ namespace MapRenderer {
     public:
         MapRenderer() = default;
         
-        void UpdateRendererMap(const std::unordered_map<std::string_view, TransportCatalogue::Bus*>& buses,
-        const std::unordered_map<std::string_view, TransportCatalogue::Stop*>& stops);
+        // Запоминает автобусы и остановки справочника; если с прошлого раза менялись только расстояния,
+        // ничего не пересобирает
+        void UpdateRendererMap(const TransportCatalogue::TransportCatalogue& catalogue);
 
+        // Карта рисуется один раз и заново - после изменений остановок, автобусов или настроек
         void RenderMap(std::ostream& out);
         void SetRenderSettings (RenderSettings&& render_settings);
         
@@ -122,13 +128,18 @@ namespace MapRenderer {
 
 
         void SetBusLineSettings(svg::Polyline& line) const;
-        void SetBusNameTextSettings(svg::Text& text, TransportCatalogue::Bus* bus_ptr) const;
-        void SetStopNameTextSettings(svg::Text& text, TransportCatalogue::Stop* stop_ptr) const;
-
-        std::vector<TransportCatalogue::Bus*> buses_;
-        std::vector<TransportCatalogue::Stop*> stops_;
+        void SetBusNameTextSettings(svg::Text& text, const TransportCatalogue::Bus& bus) const;
+        void SetStopNameTextSettings(svg::Text& text, const TransportCatalogue::Stop& stop) const;
+
+        const TransportCatalogue::TransportCatalogue* catalogue_ = nullptr;
+        //версия справочника, по которой собраны buses_ и stops_
+        std::uint64_t catalogue_version_ = 0;
+        std::vector<TransportCatalogue::Bus> buses_;
+        std::vector<TransportCatalogue::Stop> stops_;
         
         svg::Document document_;
+        //готовая карта, сбрасывается при изменении справочника или настроек
+        std::optional<std::string> rendered_map_;
         RenderSettings render_settings_;
     };
 }
@@ -0,0 +1,69 @@
+#include "mapped_file.h"
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define STORAGE_HAS_MMAP
+#endif
+
+namespace storage {
+
+#ifdef STORAGE_HAS_MMAP
+    MappedFile::MappedFile(const std::string& path) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd == -1) {
+            throw std::runtime_error("Can't open file " + path);
+        }
+        struct stat file_stat;
+        if (fstat(fd, &file_stat) == -1) {
+            close(fd);
+            throw std::runtime_error("Can't get size of file " + path);
+        }
+        size_ = static_cast<size_t>(file_stat.st_size);
+        if (size_ > 0) {
+            void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("Can't map file " + path);
+            }
+            data_ = static_cast<const char*>(data);
+            is_mapped_ = true;
+        }
+        //отображение остаётся действительным и после закрытия дескриптора
+        close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (is_mapped_) {
+            munmap(const_cast<char*>(data_), size_);
+        }
+    }
+#else
+    MappedFile::MappedFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Can't open file " + path);
+        }
+        buffer_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        data_ = buffer_.data();
+        size_ = buffer_.size();
+    }
+
+    MappedFile::~MappedFile() = default;
+#endif
+
+    const char* MappedFile::GetData() const noexcept {
+        return data_;
+    }
+
+    size_t MappedFile::GetSize() const noexcept {
+        return size_;
+    }
+
+}  // namespace storage
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace storage {
+
+    // Файл, отображённый в память только для чтения.
+    // Там, где нет mmap, содержимое файла читается в память целиком.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const char* GetData() const noexcept;
+        size_t GetSize() const noexcept;
+
+    private:
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+        bool is_mapped_ = false;
+        std::vector<char> buffer_;
+    };
+
+}  // namespace storage
@@ -0,0 +1,268 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace names {
+
+    // Хеш имени: по 8 байт за шаг и перемешивание в конце, чтобы короткие похожие имена ("S1", "S2") расходились
+    inline std::uint64_t HashName(std::string_view name) noexcept {
+        constexpr std::uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+        const char* data = name.data();
+        const size_t size = name.size();
+        std::uint64_t hash = size * MULTIPLIER;
+        size_t position = 0;
+        for (; position + sizeof(std::uint64_t) <= size; position += sizeof(std::uint64_t)) {
+            std::uint64_t word;
+            std::memcpy(&word, data + position, sizeof(word));
+            hash = (hash ^ word) * MULTIPLIER;
+            hash ^= hash >> 32;
+        }
+        std::uint64_t tail = 0;
+        if (position < size) {
+            std::memcpy(&tail, data + position, size - position);
+        }
+        hash = (hash ^ tail) * MULTIPLIER;
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    // Индекс имя -> номер с открытой адресацией. Ключи - string_view на имена, которые хранит владелец индекса
+    // и которые не перемещаются. Поиск принимает string_view, поэтому std::string и const char* ищутся без копий.
+    // Пробирование линейное по плотному массиву меток (часть хеша), строки сравниваются только при совпадении метки.
+    // Интерфейс повторяет нужную часть unordered_map, порядок обхода не определён.
+    template <typename Id>
+    class NameIndex {
+    public:
+        using value_type = std::pair<std::string_view, Id>;
+
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = NameIndex::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type*;
+            using reference = const value_type&;
+
+            const_iterator() = default;
+
+            reference operator*() const {
+                return index_->entries_[slot_];
+            }
+            pointer operator->() const {
+                return &index_->entries_[slot_];
+            }
+            const_iterator& operator++() {
+                slot_ = index_->SkipEmpty(slot_ + 1);
+                return *this;
+            }
+            const_iterator operator++(int) {
+                const_iterator result = *this;
+                ++*this;
+                return result;
+            }
+            bool operator==(const const_iterator& other) const {
+                return slot_ == other.slot_;
+            }
+            bool operator!=(const const_iterator& other) const {
+                return slot_ != other.slot_;
+            }
+
+        private:
+            friend class NameIndex;
+            const_iterator(const NameIndex* index, size_t slot) : index_(index), slot_(slot) {
+            }
+
+            const NameIndex* index_ = nullptr;
+            size_t slot_ = 0;
+        };
+
+        explicit NameIndex(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+        const_iterator begin() const;
+        const_iterator end() const;
+        size_t size() const noexcept;
+        bool empty() const noexcept;
+
+        const_iterator find(std::string_view name) const;
+        size_t count(std::string_view name) const;
+        // Бросает out_of_range, если имени нет
+        const Id& at(std::string_view name) const;
+
+        // Добавляет имя или заменяет его номер
+        void insert_or_assign(std::string_view name, Id id);
+        // Удаляет имя, возвращает число удалённых (0 или 1)
+        size_t erase(std::string_view name);
+        // Готовит место под count имён без перестроек
+        void reserve(size_t count);
+
+    private:
+        //метка пустого слота; у занятых слотов старший бит метки установлен
+        static constexpr std::uint32_t EMPTY = 0;
+        static constexpr size_t MIN_CAPACITY = 16;
+
+        static std::uint32_t GetTag(std::uint64_t hash) noexcept {
+            return static_cast<std::uint32_t>(hash >> 32) | 0x80000000u;
+        }
+        size_t FindSlot(std::string_view name, std::uint64_t hash) const;
+        size_t SkipEmpty(size_t slot) const;
+        void Rehash(size_t capacity);
+
+        std::pmr::vector<std::uint32_t> tags_;
+        std::pmr::vector<value_type> entries_;
+        size_t size_ = 0;
+    };
+
+    template <typename Id>
+    NameIndex<Id>::NameIndex(std::pmr::memory_resource* resource)
+        : tags_(resource)
+        , entries_(resource) {
+    }
+
+    template <typename Id>
+    typename NameIndex<Id>::const_iterator NameIndex<Id>::begin() const {
+        return const_iterator(this, SkipEmpty(0));
+    }
+
+    template <typename Id>
+    typename NameIndex<Id>::const_iterator NameIndex<Id>::end() const {
+        return const_iterator(this, tags_.size());
+    }
+
+    template <typename Id>
+    size_t NameIndex<Id>::size() const noexcept {
+        return size_;
+    }
+
+    template <typename Id>
+    bool NameIndex<Id>::empty() const noexcept {
+        return size_ == 0;
+    }
+
+    template <typename Id>
+    typename NameIndex<Id>::const_iterator NameIndex<Id>::find(std::string_view name) const {
+        if (size_ == 0) {
+            return end();
+        }
+        const size_t slot = FindSlot(name, HashName(name));
+        return tags_[slot] == EMPTY ? end() : const_iterator(this, slot);
+    }
+
+    template <typename Id>
+    size_t NameIndex<Id>::count(std::string_view name) const {
+        return find(name) == end() ? 0 : 1;
+    }
+
+    template <typename Id>
+    const Id& NameIndex<Id>::at(std::string_view name) const {
+        const auto it = find(name);
+        if (it == end()) {
+            throw std::out_of_range("Name isn't in the index");
+        }
+        return it->second;
+    }
+
+    template <typename Id>
+    void NameIndex<Id>::insert_or_assign(std::string_view name, Id id) {
+        //заполнение не больше 3/4
+        if ((size_ + 1) * 4 > tags_.size() * 3) {
+            Rehash(std::max(MIN_CAPACITY, tags_.size() * 2));
+        }
+        const std::uint64_t hash = HashName(name);
+        const size_t slot = FindSlot(name, hash);
+        if (tags_[slot] == EMPTY) {
+            tags_[slot] = GetTag(hash);
+            entries_[slot].first = name;
+            ++size_;
+        }
+        entries_[slot].second = id;
+    }
+
+    // Надгробий нет: следующие за дырой имена цепочки сдвигаются назад, если их домашний слот не лежит между дырой и ними
+    template <typename Id>
+    size_t NameIndex<Id>::erase(std::string_view name) {
+        if (size_ == 0) {
+            return 0;
+        }
+        size_t hole = FindSlot(name, HashName(name));
+        if (tags_[hole] == EMPTY) {
+            return 0;
+        }
+        const size_t mask = tags_.size() - 1;
+        for (size_t slot = (hole + 1) & mask; tags_[slot] != EMPTY; slot = (slot + 1) & mask) {
+            const size_t home = static_cast<size_t>(HashName(entries_[slot].first)) & mask;
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                tags_[hole] = tags_[slot];
+                entries_[hole] = entries_[slot];
+                hole = slot;
+            }
+        }
+        tags_[hole] = EMPTY;
+        entries_[hole] = {};
+        --size_;
+        return 1;
+    }
+
+    template <typename Id>
+    void NameIndex<Id>::reserve(size_t count) {
+        size_t capacity = MIN_CAPACITY;
+        while (count * 4 > capacity * 3) {
+            capacity *= 2;
+        }
+        if (capacity > tags_.size()) {
+            Rehash(capacity);
+        }
+    }
+
+    // Слот с этим именем или пустой слот, где поиск остановился
+    template <typename Id>
+    size_t NameIndex<Id>::FindSlot(std::string_view name, std::uint64_t hash) const {
+        const size_t mask = tags_.size() - 1;
+        const std::uint32_t tag = GetTag(hash);
+        for (size_t slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask) {
+            if (tags_[slot] == EMPTY || (tags_[slot] == tag && entries_[slot].first == name)) {
+                return slot;
+            }
+        }
+    }
+
+    template <typename Id>
+    size_t NameIndex<Id>::SkipEmpty(size_t slot) const {
+        while (slot < tags_.size() && tags_[slot] == EMPTY) {
+            ++slot;
+        }
+        return slot;
+    }
+
+    template <typename Id>
+    void NameIndex<Id>::Rehash(size_t capacity) {
+        std::pmr::vector<std::uint32_t> old_tags(capacity, EMPTY, tags_.get_allocator());
+        std::pmr::vector<value_type> old_entries(capacity, entries_.get_allocator());
+        old_tags.swap(tags_);
+        old_entries.swap(entries_);
+        const size_t mask = capacity - 1;
+        for (size_t old_slot = 0; old_slot < old_tags.size(); ++old_slot) {
+            if (old_tags[old_slot] == EMPTY) {
+                continue;
+            }
+            //имена уникальны, поэтому строки не сравниваем
+            size_t slot = static_cast<size_t>(HashName(old_entries[old_slot].first)) & mask;
+            while (tags_[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            tags_[slot] = old_tags[old_slot];
+            entries_[slot] = old_entries[old_slot];
+        }
+    }
+
+}  // namespace names
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace graph {
+
+    // Многокритериальный поиск: вес пути и число пройденных «отмеченных» рёбер (например, посадок в автобус).
+    // Метки извлекаются из очереди по возрастанию (вес, число), поэтому у вершины остаются только метки
+    // со строго убывающим числом, и новая метка отбрасывается, если её число не меньше, чем у уже извлечённых
+    // в этой вершине или в цели. Меток у вершины не больше max_count + 1.
+    template <typename Weight>
+    class ParetoRouter {
+    private:
+        using Graph = DirectedWeightedGraph<Weight>;
+
+    public:
+        using EdgeCounter = std::function<bool(EdgeId)>;
+
+        struct RouteInfo {
+            Weight weight;
+            size_t count = 0;
+            std::vector<EdgeId> edges;
+        };
+
+        ParetoRouter(const Graph& graph, EdgeCounter counts_edge);
+
+        // Все недоминируемые пути из from в to, в которых не больше max_count отмеченных рёбер,
+        // по возрастанию веса (и убыванию числа отмеченных рёбер)
+        std::vector<RouteInfo> BuildRoutes(VertexId from, VertexId to,
+                                           size_t max_count = std::numeric_limits<size_t>::max()) const;
+
+    private:
+        static constexpr size_t NO_LABEL = std::numeric_limits<size_t>::max();
+        static constexpr size_t NO_COUNT = std::numeric_limits<size_t>::max();
+
+        struct Label {
+            Weight weight;
+            size_t count;
+            VertexId vertex;
+            EdgeId edge;
+            size_t parent;
+        };
+        using QueueItem = std::tuple<Weight, size_t, size_t>;
+        using Queue = std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>>;
+
+        static constexpr Weight ZERO_WEIGHT{};
+        const Graph& graph_;
+        EdgeCounter counts_edge_;
+    };
+
+    template <typename Weight>
+    ParetoRouter<Weight>::ParetoRouter(const Graph& graph, EdgeCounter counts_edge)
+        : graph_(graph)
+        , counts_edge_(std::move(counts_edge))
+    {
+        if (!counts_edge_) {
+            throw std::invalid_argument("Pareto search needs an edge counter");
+        }
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        for (EdgeId edge_id = 0; edge_id < graph.GetEdgeCount(); ++edge_id) {
+            if (graph.GetEdge(edge_id).weight < ZERO_WEIGHT) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+        }
+    }
+
+    template <typename Weight>
+    std::vector<typename ParetoRouter<Weight>::RouteInfo> ParetoRouter<Weight>::BuildRoutes(VertexId from, VertexId to,
+                                                                                           size_t max_count) const {
+        const size_t vertex_count = graph_.GetVertexCount();
+        if (from >= vertex_count || to >= vertex_count) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        std::vector<Label> labels = {Label{ZERO_WEIGHT, 0, from, 0, NO_LABEL}};
+        //наименьшее число среди извлечённых меток вершины
+        std::vector<size_t> min_counts(vertex_count, NO_COUNT);
+        Queue queue;
+        queue.emplace(ZERO_WEIGHT, 0, 0);
+
+        std::vector<RouteInfo> routes;
+        while (!queue.empty()) {
+            const auto [weight, count, label_index] = queue.top();
+            queue.pop();
+            const VertexId vertex = labels[label_index].vertex;
+            if (count >= min_counts[vertex] || count >= min_counts[to]) {
+                continue;
+            }
+            min_counts[vertex] = count;
+
+            if (vertex == to) {
+                std::vector<EdgeId> edges;
+                for (size_t index = label_index; labels[index].parent != NO_LABEL; index = labels[index].parent) {
+                    edges.push_back(labels[index].edge);
+                }
+                std::reverse(edges.begin(), edges.end());
+                routes.push_back(RouteInfo{weight, count, std::move(edges)});
+                continue;
+            }
+            const auto arcs = graph_.GetOutgoingArcs(vertex);
+            for (size_t arc = 0; arc < arcs.size; ++arc) {
+                const VertexId next_vertex = arcs.vertexes[arc];
+                const size_t next_count = count + (counts_edge_(arcs.edge_ids[arc]) ? 1 : 0);
+                if (next_count > max_count || next_count >= min_counts[next_vertex] || next_count >= min_counts[to]) {
+                    continue;
+                }
+                const Weight next_weight = weight + arcs.weights[arc];
+                labels.push_back(Label{next_weight, next_count, next_vertex, arcs.edge_ids[arc], label_index});
+                queue.emplace(next_weight, next_count, labels.size() - 1);
+            }
+        }
+        return routes;
+    }
+
+}  // namespace graph
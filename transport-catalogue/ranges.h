@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <iterator>
 #include <string_view>
 #include <unordered_map>
@@ -22,6 +23,21 @@ namespace ranges {
         It end() const {
             return end_;
         }
+        size_t size() const {
+            return static_cast<size_t>(std::distance(begin_, end_));
+        }
+        bool empty() const {
+            return begin_ == end_;
+        }
+        decltype(auto) operator[](size_t index) const {
+            return begin_[index];
+        }
+        decltype(auto) front() const {
+            return *begin_;
+        }
+        decltype(auto) back() const {
+            return *std::prev(end_);
+        }
     
     private:
         It begin_;
@@ -0,0 +1,274 @@
+#include "raptor_router.h"
+
+#include <algorithm>
+
+namespace TransportCatalogue {
+    namespace Router {
+
+        RaptorRouter::RaptorRouter(double bus_wait_time) : bus_wait_time_(bus_wait_time) {
+        }
+
+        void RaptorRouter::AddStop(std::string_view stop_name) {
+            stop_name_to_index_[stop_name] = static_cast<StopIndex>(stop_names_.size());
+            stop_names_.push_back(stop_name);
+            stop_lines_.emplace_back();
+        }
+
+        void RaptorRouter::AddLine(std::string_view bus_name, const std::vector<std::string_view>& stops, const std::vector<double>& times) {
+            const LineIndex line = static_cast<LineIndex>(line_bus_names_.size());
+            line_bus_names_.push_back(bus_name);
+            double time_from_start = 0.;
+            for (size_t position = 0; position < stops.size(); ++position) {
+                const StopIndex stop = stop_name_to_index_.at(stops[position]);
+                if (position > 0) {
+                    time_from_start += times.at(position - 1);
+                }
+                line_stops_.push_back(stop);
+                line_times_.push_back(time_from_start);
+                stop_lines_[stop].emplace_back(line, static_cast<uint32_t>(position));
+            }
+            line_offsets_.push_back(line_stops_.size());
+        }
+
+        void RaptorRouter::RemoveLines(std::string_view bus_name) {
+            std::vector<StopIndex> line_stops;
+            std::vector<double> line_times;
+            std::vector<size_t> line_offsets = {0};
+            std::vector<std::string_view> line_bus_names;
+            for (auto& lines : stop_lines_) {
+                lines.clear();
+            }
+            for (LineIndex line = 0; line < line_bus_names_.size(); ++line) {
+                if (line_bus_names_[line] == bus_name) {
+                    continue;
+                }
+                const LineIndex new_line = static_cast<LineIndex>(line_bus_names.size());
+                for (size_t index = line_offsets_[line]; index < line_offsets_[line + 1]; ++index) {
+                    stop_lines_[line_stops_[index]].emplace_back(new_line, static_cast<uint32_t>(index - line_offsets_[line]));
+                    line_stops.push_back(line_stops_[index]);
+                    line_times.push_back(line_times_[index]);
+                }
+                line_offsets.push_back(line_stops.size());
+                line_bus_names.push_back(line_bus_names_[line]);
+            }
+            line_stops_ = std::move(line_stops);
+            line_times_ = std::move(line_times);
+            line_offsets_ = std::move(line_offsets);
+            line_bus_names_ = std::move(line_bus_names);
+        }
+
+        bool RaptorRouter::HasStop(std::string_view stop_name) const {
+            return stop_name_to_index_.count(stop_name) > 0;
+        }
+
+        Info::Route RaptorRouter::GetRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to) const {
+            Info::Route result;
+            const StopIndex stop_from = stop_name_to_index_.at(pair_stop_from_to.first);
+            const StopIndex stop_to = stop_name_to_index_.at(pair_stop_from_to.second);
+            const StopLabels labels = ComputeStopLabels(stop_from, result.settled_vertices);
+
+            if (!labels[stop_to]) {
+                return result;
+            }
+            result.not_found = false;
+            result.total_time = labels[stop_to]->time;
+            for (StopIndex stop = stop_to; labels[stop]->leg.line != NO_INDEX;) {
+                stop = AddLegItems(labels[stop]->leg, result);
+            }
+            std::reverse(result.items_.begin(), result.items_.end());
+            result.transfer_count = result.items_.empty() ? 0 : result.items_.size() / 2 - 1;
+            return result;
+        }
+
+        Info::ParetoRoutes RaptorRouter::GetParetoRoutesInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to, size_t max_boardings) const {
+            const StopIndex stop_from = stop_name_to_index_.at(pair_stop_from_to.first);
+            const StopIndex stop_to = stop_name_to_index_.at(pair_stop_from_to.second);
+            size_t settled_vertices = 0;
+            const std::vector<StopLabels> rounds = ComputeRoundLabels(stop_from, max_boardings, settled_vertices);
+
+            Info::ParetoRoutes result;
+            for (size_t round = 0; round < rounds.size(); ++round) {
+                //метка, перенесённая из прошлого раунда, не даёт нового маршрута
+                if (!rounds[round][stop_to] || rounds[round][stop_to]->round != round) {
+                    continue;
+                }
+                Info::Route& route = result.routes.emplace_back();
+                route.not_found = false;
+                route.total_time = rounds[round][stop_to]->time;
+                route.settled_vertices = settled_vertices;
+                route.transfer_count = round > 0 ? round - 1 : 0;
+                StopIndex stop = stop_to;
+                for (const StopLabel* label = &*rounds[round][stop]; label->leg.line != NO_INDEX; label = &*rounds[label->round - 1][stop]) {
+                    stop = AddLegItems(label->leg, route);
+                }
+                std::reverse(route.items_.begin(), route.items_.end());
+            }
+            //с каждым раундом время до цели уменьшается, а маршруты нужны по возрастанию времени
+            std::reverse(result.routes.begin(), result.routes.end());
+            return result;
+        }
+
+        RaptorRouter::StopIndex RaptorRouter::AddLegItems(const Leg& leg, Info::Route& route) const {
+            const size_t offset = line_offsets_[leg.line];
+            const StopIndex board_stop = line_stops_[offset + leg.board_position];
+            route.items_.emplace_back(Info::Router::BusRouteInfo{line_bus_names_[leg.line],
+                                                                 static_cast<int>(leg.alight_position - leg.board_position),
+                                                                 line_times_[offset + leg.alight_position] - line_times_[offset + leg.board_position]});
+            route.items_.emplace_back(Info::Router::WaitInfo{stop_names_[board_stop], bus_wait_time_});
+            return board_stop;
+        }
+
+        Info::Matrix RaptorRouter::GetMatrixInfo(const std::vector<std::string>& stops_from, const std::vector<std::string>& stops_to) const {
+            std::vector<StopIndex> targets;
+            targets.reserve(stops_to.size());
+            for (const auto& stop_to : stops_to) {
+                targets.push_back(stop_name_to_index_.at(stop_to));
+            }
+            Info::Matrix result;
+            result.total_times.reserve(stops_from.size());
+            size_t settled_vertices = 0;
+            for (const auto& stop_from : stops_from) {
+                const StopLabels labels = ComputeStopLabels(stop_name_to_index_.at(stop_from), settled_vertices);
+                auto& row = result.total_times.emplace_back(targets.size());
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    if (labels[targets[j]]) {
+                        row[j] = labels[targets[j]]->time;
+                    }
+                }
+            }
+            return result;
+        }
+
+        Info::Isochrone RaptorRouter::GetIsochroneInfo(std::string_view stop_from, double max_time) const {
+            size_t settled_vertices = 0;
+            const StopLabels labels = ComputeStopLabels(stop_name_to_index_.at(stop_from), settled_vertices, max_time);
+            Info::Isochrone result;
+            for (StopIndex stop = 0; stop < labels.size(); ++stop) {
+                if (labels[stop]) {
+                    result.stops.emplace_back(stop_names_[stop], labels[stop]->time);
+                }
+            }
+            std::sort(result.stops.begin(), result.stops.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second < rhs.second;
+            });
+            return result;
+        }
+
+        RaptorRouter::StopLabels RaptorRouter::ComputeStopLabels(StopIndex stop_from, size_t& settled_vertices, double max_time) const {
+            StopLabels labels(stop_names_.size());
+            std::vector<StopIndex> marked_stops = {stop_from};
+            std::vector<bool> is_marked(stop_names_.size(), false);
+            //самая ранняя позиция улучшенной остановки на линии в текущем раунде
+            std::vector<uint32_t> line_start(line_bus_names_.size(), NO_INDEX);
+            std::vector<LineIndex> lines_to_scan;
+            labels[stop_from] = StopLabel{};
+
+            while (!marked_stops.empty()) {
+                for (const StopIndex stop : marked_stops) {
+                    is_marked[stop] = false;
+                    for (const auto& [line, position] : stop_lines_[stop]) {
+                        if (line_start[line] == NO_INDEX) {
+                            lines_to_scan.push_back(line);
+                        }
+                        line_start[line] = std::min(line_start[line], position);
+                    }
+                }
+                marked_stops.clear();
+
+                for (const LineIndex line : lines_to_scan) {
+                    const size_t offset = line_offsets_[line];
+                    const size_t line_size = line_offsets_[line + 1] - offset;
+                    std::optional<uint32_t> board_position;
+                    double board_time = 0.;
+
+                    for (uint32_t position = line_start[line]; position < line_size; ++position) {
+                        const StopIndex stop = line_stops_[offset + position];
+                        const double time_from_start = line_times_[offset + position];
+                        auto& label = labels[stop];
+                        if (board_position) {
+                            const double time = board_time + time_from_start - line_times_[offset + *board_position];
+                            if (time <= max_time && (!label || time < label->time)) {
+                                label = StopLabel{time, Leg{line, *board_position, position}};
+                                ++settled_vertices;
+                                if (!is_marked[stop]) {
+                                    is_marked[stop] = true;
+                                    marked_stops.push_back(stop);
+                                }
+                            }
+                        }
+                        // пересесть здесь выгоднее, чем продолжить поездку с прежней посадки
+                        if (label && (!board_position || label->time + bus_wait_time_ - time_from_start
+                                                         < board_time - line_times_[offset + *board_position])) {
+                            board_position = position;
+                            board_time = label->time + bus_wait_time_;
+                        }
+                    }
+                    line_start[line] = NO_INDEX;
+                }
+                lines_to_scan.clear();
+            }
+            return labels;
+        }
+
+        std::vector<RaptorRouter::StopLabels> RaptorRouter::ComputeRoundLabels(StopIndex stop_from, size_t max_rounds, size_t& settled_vertices) const {
+            std::vector<StopLabels> rounds(1, StopLabels(stop_names_.size()));
+            rounds[0][stop_from] = StopLabel{};
+            std::vector<StopIndex> marked_stops = {stop_from};
+            std::vector<bool> is_marked(stop_names_.size(), false);
+            std::vector<uint32_t> line_start(line_bus_names_.size(), NO_INDEX);
+            std::vector<LineIndex> lines_to_scan;
+
+            for (uint32_t round = 1; round <= max_rounds && !marked_stops.empty(); ++round) {
+                //раунд начинается с лучших меток предыдущего, а садиться можно только по меткам предыдущего раунда
+                rounds.push_back(rounds.back());
+                const StopLabels& previous_labels = rounds[round - 1];
+                StopLabels& labels = rounds[round];
+
+                for (const StopIndex stop : marked_stops) {
+                    is_marked[stop] = false;
+                    for (const auto& [line, position] : stop_lines_[stop]) {
+                        if (line_start[line] == NO_INDEX) {
+                            lines_to_scan.push_back(line);
+                        }
+                        line_start[line] = std::min(line_start[line], position);
+                    }
+                }
+                marked_stops.clear();
+
+                for (const LineIndex line : lines_to_scan) {
+                    const size_t offset = line_offsets_[line];
+                    const size_t line_size = line_offsets_[line + 1] - offset;
+                    std::optional<uint32_t> board_position;
+                    double board_time = 0.;
+
+                    for (uint32_t position = line_start[line]; position < line_size; ++position) {
+                        const StopIndex stop = line_stops_[offset + position];
+                        const double time_from_start = line_times_[offset + position];
+                        auto& label = labels[stop];
+                        if (board_position) {
+                            const double time = board_time + time_from_start - line_times_[offset + *board_position];
+                            if (!label || time < label->time) {
+                                label = StopLabel{time, Leg{line, *board_position, position}, round};
+                                ++settled_vertices;
+                                if (!is_marked[stop]) {
+                                    is_marked[stop] = true;
+                                    marked_stops.push_back(stop);
+                                }
+                            }
+                        }
+                        const auto& previous_label = previous_labels[stop];
+                        if (previous_label && (!board_position || previous_label->time + bus_wait_time_ - time_from_start
+                                                                  < board_time - line_times_[offset + *board_position])) {
+                            board_position = position;
+                            board_time = previous_label->time + bus_wait_time_;
+                        }
+                    }
+                    line_start[line] = NO_INDEX;
+                }
+                lines_to_scan.clear();
+            }
+            return rounds;
+        }
+
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "domain.h"
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace TransportCatalogue {
+    namespace Router {
+
+        // Поиск маршрута по последовательностям остановок автобусов в духе RAPTOR.
+        // Граф с рёбрами «каждая остановка - каждая следующая остановка автобуса» не строится:
+        // каждый раунд просматривает линии, проходящие через улучшенные остановки, и продлевает поездки вдоль них.
+        // Память линейна по суммарному числу остановок всех линий.
+        class RaptorRouter {
+        public:
+            explicit RaptorRouter(double bus_wait_time);
+
+            void AddStop(std::string_view stop_name);
+            // times[i] - время перегона от stops[i] до stops[i + 1]
+            void AddLine(std::string_view bus_name, const std::vector<std::string_view>& stops, const std::vector<double>& times);
+            // Удаляет все линии автобуса (для некольцевого - обе)
+            void RemoveLines(std::string_view bus_name);
+            bool HasStop(std::string_view stop_name) const;
+
+            Info::Route GetRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to) const;
+            // Раунд k находит самые быстрые маршруты не больше чем с k посадками,
+            // поэтому недоминируемые маршруты - это раунды, в которых улучшилось время до цели
+            Info::ParetoRoutes GetParetoRoutesInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to, size_t max_boardings) const;
+            // Раунды от остановки не зависят от цели, поэтому на каждую начальную остановку нужен один проход
+            Info::Matrix GetMatrixInfo(const std::vector<std::string>& stops_from, const std::vector<std::string>& stops_to) const;
+            // Раунды не продлевают поездки дальше max_time, поэтому просматриваются только линии достижимой области
+            Info::Isochrone GetIsochroneInfo(std::string_view stop_from, double max_time) const;
+
+        private:
+            using StopIndex = uint32_t;
+            using LineIndex = uint32_t;
+            static constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+            // Поездка, которой достигнута остановка: линия, позиции посадки и высадки
+            struct Leg {
+                LineIndex line = NO_INDEX;
+                uint32_t board_position = 0;
+                uint32_t alight_position = 0;
+            };
+
+            struct StopLabel {
+                double time = 0.;
+                Leg leg;
+                //раунд, в котором поставлена метка (для поиска по раундам)
+                uint32_t round = 0;
+            };
+            using StopLabels = std::vector<std::optional<StopLabel>>;
+
+            //остановки, до которых дольше max_time, не получают метку
+            StopLabels ComputeStopLabels(StopIndex stop_from, size_t& settled_vertices,
+                                         double max_time = std::numeric_limits<double>::infinity()) const;
+            //метки каждого раунда: rounds[k] - лучшие метки не больше чем с k посадками
+            std::vector<StopLabels> ComputeRoundLabels(StopIndex stop_from, size_t max_rounds, size_t& settled_vertices) const;
+            //добавляет в маршрут поездку и ожидание перед ней, возвращает остановку посадки
+            StopIndex AddLegItems(const Leg& leg, Info::Route& route) const;
+
+            double bus_wait_time_ = 0.;
+            std::unordered_map<std::string_view, StopIndex> stop_name_to_index_;
+            std::vector<std::string_view> stop_names_;
+
+            //остановки всех линий подряд, line_offsets_[line] - начало линии
+            std::vector<StopIndex> line_stops_;
+            //время от начала линии до остановки
+            std::vector<double> line_times_;
+            std::vector<size_t> line_offsets_ = {0};
+            std::vector<std::string_view> line_bus_names_;
+
+            //линии, проходящие через остановку, и позиции остановки на них
+            std::vector<std::vector<std::pair<LineIndex, uint32_t>>> stop_lines_;
+        };
+
+    }
+}
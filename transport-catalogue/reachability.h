@@ -0,0 +1,60 @@
+#pragma once
+
+#include "graph.h"
+
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace graph {
+
+    // Все вершины, достижимые из from путём веса не больше max_weight, с весами кратчайших путей
+    // в порядке их извлечения из очереди. Поиск Дейкстры обрывается на первой вершине дальше max_weight,
+    // а расстояния хранятся в хеш-таблице, поэтому время и память зависят от размера достижимой области, а не всего графа.
+    template <typename Weight>
+    std::vector<std::pair<VertexId, Weight>> FindReachableVertices(const DirectedWeightedGraph<Weight>& graph,
+                                                                   VertexId from, Weight max_weight) {
+        if (!graph.IsFrozen()) {
+            throw std::logic_error("Graph should be frozen before routing");
+        }
+        if (from >= graph.GetVertexCount()) {
+            throw std::out_of_range("Vertex is out of range");
+        }
+        using QueueItem = std::pair<Weight, VertexId>;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+        //вес лучшего найденного пути; у извлечённых вершин - окончательный
+        std::unordered_map<VertexId, Weight> weights;
+        std::vector<std::pair<VertexId, Weight>> result;
+
+        weights.emplace(from, Weight{});
+        queue.emplace(Weight{}, from);
+        while (!queue.empty()) {
+            const auto [weight, vertex] = queue.top();
+            queue.pop();
+            if (max_weight < weight) {
+                break;
+            }
+            if (weights.at(vertex) < weight) {
+                continue;
+            }
+            result.emplace_back(vertex, weight);
+            const auto arcs = graph.GetOutgoingArcs(vertex);
+            for (size_t arc = 0; arc < arcs.size; ++arc) {
+                const Weight candidate_weight = weight + arcs.weights[arc];
+                if (max_weight < candidate_weight) {
+                    continue;
+                }
+                const auto [it, inserted] = weights.emplace(arcs.vertexes[arc], candidate_weight);
+                if (inserted || candidate_weight < it->second) {
+                    it->second = candidate_weight;
+                    queue.emplace(candidate_weight, arcs.vertexes[arc]);
+                }
+            }
+        }
+        return result;
+    }
+
+}  // namespace graph
@@ -1,5 +1,10 @@
 #include "request_handler.h"
 
+#include <algorithm>
+#include <thread>
+
+#include "thread_pool.h"
+
 using namespace std::literals;
 
 RequestHandler::RequestHandler::RequestHandler(TransportCatalogue::TransportCatalogue &catalogue, MapRenderer::MapRenderer &renderer, TransportCatalogue::Router::TransportRouter &router)  
@@ -18,27 +23,76 @@ std::vector<std::pair<int, RequestHandler::RequestInfo>> RequestHandler::Request
 }
 
 void RequestHandler::RequestHandler::ParseStats() {
+    //каждый вызов отвечает только на запросы, добавленные после предыдущего
+    requests_info_.clear();
+    //зависимые от справочника данные пересобираются только после его изменений
+    router_->ApplyCatalogueChanges();
     UploadRendererMap();
-    for (auto&& request : stat_requests_) {
-        if (request.type == "Bus"s) {
-            requests_info_.emplace_back(request.id, std::move(data_base_->GetInfoAboutBus(std::get<std::string>(request.value))));
-        } else if (request.type == "Stop"s) {
-            requests_info_.emplace_back(request.id, std::move(data_base_->GetInfoAboutStop(std::get<std::string>(request.value))));
+    if (!snapshot_ || snapshot_->GetVersion() != data_base_->GetVersion()) {
+        snapshot_ = data_base_->Freeze();
+    }
+    std::vector<std::optional<RequestInfo>> requests_info(stat_requests_.size());
+    ParseCatalogueStats(requests_info);
+    for (size_t i = 0; i < stat_requests_.size(); ++i) {
+        const auto& request = stat_requests_[i];
+        if (request.type == "Route"s && std::holds_alternative<RouteOptions>(request.value)) {
+            const auto& options = std::get<RouteOptions>(request.value);
+            if (options.pareto) {
+                requests_info[i] = router_->GetParetoRoutesInfo(options.stops, options.max_transfers);
+            } else if (options.max_transfers) {
+                requests_info[i] = router_->GetRouteInfo(options.stops, *options.max_transfers);
+            } else {
+                requests_info[i] = router_->GetRouteInfo(options.stops);
+            }
         } else if (request.type == "Route"s) {
-            requests_info_.emplace_back(request.id, std::move(router_->GetRouteInfo(std::get<std::pair<std::string, std::string>>(request.value))));
+            requests_info[i] = router_->GetRouteInfo(std::get<std::pair<std::string, std::string>>(request.value));
+        } else if (request.type == "Matrix"s) {
+            const auto& [stops_from, stops_to] = std::get<std::pair<std::vector<std::string>, std::vector<std::string>>>(request.value);
+            requests_info[i] = router_->GetMatrixInfo(stops_from, stops_to);
+        } else if (request.type == "Isochrone"s) {
+            const auto& [stop_from, max_time] = std::get<std::pair<std::string, double>>(request.value);
+            requests_info[i] = router_->GetIsochroneInfo(stop_from, max_time);
         } else if (request.type == "Map"s) {
             std::ostringstream ss;
             map_renderer_->RenderMap(ss);
-            requests_info_.emplace_back(request.id, std::move(ss.str()));
+            requests_info[i] = ss.str();
+        }
+    }
+    for (size_t i = 0; i < stat_requests_.size(); ++i) {
+        if (requests_info[i]) {
+            requests_info_.emplace_back(stat_requests_[i].id, std::move(*requests_info[i]));
+        }
+    }
+    stat_requests_.clear();
+}
+
+// Запросы Bus и Stop читают только неизменяемый снимок справочника, поэтому на них отвечаем параллельно
+void RequestHandler::RequestHandler::ParseCatalogueStats(std::vector<std::optional<RequestInfo>>& requests_info) {
+    const size_t task_count = (stat_requests_.size() + REQUESTS_PER_TASK - 1) / REQUESTS_PER_TASK;
+    if (task_count > 1 && !thread_pool_) {
+        thread_pool_ = std::make_unique<parallel::ThreadPool>(std::thread::hardware_concurrency());
+    }
+    const auto answer = [&](size_t task) {
+        const size_t end = std::min(stat_requests_.size(), (task + 1) * REQUESTS_PER_TASK);
+        for (size_t i = task * REQUESTS_PER_TASK; i < end; ++i) {
+            const auto& request = stat_requests_[i];
+            if (request.type == "Bus"s) {
+                requests_info[i] = snapshot_->GetInfoAboutBus(std::get<std::string>(request.value));
+            } else if (request.type == "Stop"s) {
+                requests_info[i] = snapshot_->GetInfoAboutStop(std::get<std::string>(request.value));
+            }
         }
+    };
+    if (task_count > 1) {
+        thread_pool_->ParallelFor(task_count, answer);
+    } else if (task_count == 1) {
+        answer(0);
     }
 }
 
 
 void RequestHandler::RequestHandler::UploadRendererMap() {
-    auto buses = data_base_->GetReferenseBuses();
-    auto stops = data_base_->GetReferenseStops();
-    map_renderer_->UpdateRendererMap(buses, stops);
+    map_renderer_->UpdateRendererMap(*data_base_);
 
 }
 
@@ -1,17 +1,30 @@
 #pragma once
 
+#include "catalogue_snapshot.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
 #include "map_renderer.h"
+#include "thread_pool.h"
 
+#include <memory>
+#include <optional>
 #include <sstream>
 #include <variant>
 #include <vector>
 #include <unordered_map>
 
 namespace RequestHandler {
-    using RequestInfo = std::variant<std::string, TransportCatalogue::Info::Bus, TransportCatalogue::Info::Stop, TransportCatalogue::Info::Route>; 
-    using RequestValue = std::variant<std::monostate, std::string, std::pair<std::string, std::string>>;
+    // Маршрут с ограничением числа пересадок или все недоминируемые маршруты (pareto)
+    struct RouteOptions {
+        std::pair<std::string, std::string> stops;
+        bool pareto = false;
+        std::optional<size_t> max_transfers;
+    };
+
+    using RequestInfo = std::variant<std::string, TransportCatalogue::Info::Bus, TransportCatalogue::Info::Stop, TransportCatalogue::Info::Route, TransportCatalogue::Info::Matrix,
+                                     TransportCatalogue::Info::ParetoRoutes, TransportCatalogue::Info::Isochrone>; 
+    using RequestValue = std::variant<std::monostate, std::string, std::pair<std::string, std::string>, std::pair<std::vector<std::string>, std::vector<std::string>>,
+                                      RouteOptions, std::pair<std::string, double>>;
 
     class RequestHandler {
     public:
@@ -25,7 +38,11 @@ namespace RequestHandler {
         void ParseStats();
         
     private:
+        //число запросов Bus и Stop в одной задаче пула потоков
+        static constexpr size_t REQUESTS_PER_TASK = 256;
+
         void UploadRendererMap();
+        void ParseCatalogueStats(std::vector<std::optional<RequestInfo>>& requests_info);
  
         struct StatRequest{
             StatRequest(int id,const std::string& type, const RequestValue& value) : id(id)
@@ -42,8 +59,12 @@ namespace RequestHandler {
         std::vector<std::pair<int, RequestInfo>> requests_info_;
         
         TransportCatalogue::TransportCatalogue* data_base_ = nullptr;
+        //снимок справочника для ответов на запросы Bus и Stop
+        std::shared_ptr<const TransportCatalogue::CatalogueSnapshot> snapshot_;
         MapRenderer::MapRenderer* map_renderer_ = nullptr;
         TransportCatalogue::Router::TransportRouter* router_ = nullptr;
+        //пул для ответов на Bus и Stop, создаётся при первой пачке, которой он нужен
+        std::unique_ptr<parallel::ThreadPool> thread_pool_;
 
     };
  
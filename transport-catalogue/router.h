@@ -1,117 +1,372 @@
 #pragma once
 
 #include "graph.h"
+#include "router_engine.h"
+#include "thread_pool.h"
 
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <variant>
 #include <vector>
 
 namespace graph {
 
+    // Предвычисление кратчайших путей между всеми парами вершин.
+    // Таблица хранится двумя плоскими матрицами V x V (веса и последние рёбра путей)
+    // и заполняется блочным алгоритмом Флойда–Уоршелла: на каждом шаге сначала диагональный блок,
+    // затем параллельно блоки его строки и столбца, затем параллельно все остальные блоки.
+    // Если номера рёбер помещаются в 32 бита, они хранятся как uint32_t: 12 байт на ячейку вместо 16.
+    // Готовую таблицу можно сохранить и затем передать роутеру извне, например из отображённого в память файла.
+    // Новые рёбра графа добавляются в таблицу релаксацией только через их концы, без полного пересчёта.
     template <typename Weight>
-    class Router {
+    class Router final : public RouterEngine<Weight> {
     private:
         using Graph = DirectedWeightedGraph<Weight>;
-    
+        static_assert(std::numeric_limits<Weight>::has_infinity, "Weight should have an infinity value");
+
     public:
-        explicit Router(const Graph& graph);
-    
-        struct RouteInfo {
-            Weight weight;
-            std::vector<EdgeId> edges;
+        using RouteInfo = typename RouterEngine<Weight>::RouteInfo;
+        using WeightsMatrix = typename RouterEngine<Weight>::WeightsMatrix;
+
+        // Матрицы V x V по строкам: веса путей и последние рёбра путей
+        template <typename EdgeIndex>
+        struct RoutesTable {
+            static constexpr EdgeIndex NO_EDGE = std::numeric_limits<EdgeIndex>::max();
+
+            const Weight* weights = nullptr;
+            const EdgeIndex* prev_edges = nullptr;
         };
-    
-        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
-    
+        using CompactRoutesTable = RoutesTable<std::uint32_t>;
+        using WideRoutesTable = RoutesTable<EdgeId>;
+        using RoutesTableVariant = std::variant<CompactRoutesTable, WideRoutesTable>;
+
+        explicit Router(const Graph& graph, size_t thread_count = std::thread::hardware_concurrency());
+        // Таблица, посчитанная заранее для этого же графа; storage владеет её памятью
+        Router(const Graph& graph, RoutesTableVariant routes_table, std::shared_ptr<const void> storage);
+
+        std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const override;
+        WeightsMatrix BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                         const std::vector<VertexId>& targets) const override;
+
+        // Учитывает рёбра графа с номерами от first_edge_id, добавленные после построения таблицы.
+        // Число вершин графа и веса прежних рёбер меняться не должны. O(K V^2) для K концов новых рёбер.
+        void AddEdges(EdgeId first_edge_id, size_t thread_count = std::thread::hardware_concurrency());
+
+        // Объём таблицы маршрутов в байтах
+        size_t GetRoutesInternalDataBytes() const;
+        RoutesTableVariant GetRoutesTable() const;
+
     private:
-        struct RouteInternalData {
-            Weight weight;
-            std::optional<EdgeId> prev_edge;
+        static constexpr size_t BLOCK_SIZE = 64;
+        static constexpr Weight ZERO_WEIGHT{};
+        static constexpr Weight INFINITE_WEIGHT = std::numeric_limits<Weight>::infinity();
+
+        // Номер последнего ребра пути хранится в EdgeIndex, отсутствие ребра - максимальное значение типа.
+        // Ячейка занимает sizeof(Weight) + 4 байта: для double это 12 байт против 32 у прежних строк из optional.
+        // Вес не сужается до float: ошибки округления при релаксации копятся вдоль пути и меняют выбор маршрута
+        // при почти равных временах и само время в ответах
+        template <typename EdgeIndex>
+        struct RoutesInternalData {
+            static constexpr EdgeIndex NO_EDGE = RoutesTable<EdgeIndex>::NO_EDGE;
+
+            explicit RoutesInternalData(size_t vertex_count)
+                : weights(vertex_count * vertex_count, INFINITE_WEIGHT)
+                , prev_edges(vertex_count * vertex_count, NO_EDGE) {
+            }
+
+            std::vector<Weight> weights;
+            std::vector<EdgeIndex> prev_edges;
         };
-        using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
-    
-        void InitializeRoutesInternalData(const Graph& graph) {
-            const size_t vertex_count = graph.GetVertexCount();
-            for (VertexId vertex = 0; vertex < vertex_count; ++vertex) {
-                routes_internal_data_[vertex][vertex] = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        using CompactRoutesInternalData = RoutesInternalData<std::uint32_t>;
+        using WideRoutesInternalData = RoutesInternalData<EdgeId>;
+
+        template <typename EdgeIndex>
+        void InitializeRoutesInternalData(const Graph& graph, RoutesInternalData<EdgeIndex>& routes) const {
+            for (VertexId vertex = 0; vertex < vertex_count_; ++vertex) {
+                routes.weights[vertex * vertex_count_ + vertex] = ZERO_WEIGHT;
                 for (const EdgeId edge_id : graph.GetIncidentEdges(vertex)) {
                     const auto& edge = graph.GetEdge(edge_id);
                     if (edge.weight < ZERO_WEIGHT) {
                         throw std::domain_error("Edges' weights should be non-negative");
                     }
-                    auto& route_internal_data = routes_internal_data_[vertex][edge.to];
-                    if (!route_internal_data || route_internal_data->weight > edge.weight) {
-                        route_internal_data = RouteInternalData{edge.weight, edge_id};
+                    const size_t cell = vertex * vertex_count_ + edge.to;
+                    if (routes.weights[cell] > edge.weight) {
+                        routes.weights[cell] = edge.weight;
+                        routes.prev_edges[cell] = static_cast<EdgeIndex>(edge_id);
                     }
                 }
             }
         }
-    
-        void RelaxRoute(VertexId vertex_from, VertexId vertex_to, const RouteInternalData& route_from,
-                        const RouteInternalData& route_to) {
-            auto& route_relaxing = routes_internal_data_[vertex_from][vertex_to];
-            const Weight candidate_weight = route_from.weight + route_to.weight;
-            if (!route_relaxing || candidate_weight < route_relaxing->weight) {
-                route_relaxing = {candidate_weight,
-                                  route_to.prev_edge ? route_to.prev_edge : route_from.prev_edge};
+
+        // Релаксация блока (block_from, block_to) через вершины блока block_through
+        template <typename EdgeIndex>
+        void RelaxBlockThroughBlock(RoutesInternalData<EdgeIndex>& routes,
+                                    size_t block_from, size_t block_to, size_t block_through) const {
+            const VertexId to_begin = block_to * BLOCK_SIZE;
+            const size_t to_size = std::min(BLOCK_SIZE, vertex_count_ - to_begin);
+            const VertexId through_end = std::min(vertex_count_, (block_through + 1) * BLOCK_SIZE);
+            const VertexId from_end = std::min(vertex_count_, (block_from + 1) * BLOCK_SIZE);
+            Weight* weights = routes.weights.data();
+            EdgeIndex* prev_edges = routes.prev_edges.data();
+
+            for (VertexId vertex_through = block_through * BLOCK_SIZE; vertex_through < through_end; ++vertex_through) {
+                const size_t row_through = vertex_through * vertex_count_ + to_begin;
+                for (VertexId vertex_from = block_from * BLOCK_SIZE; vertex_from < from_end; ++vertex_from) {
+                    const Weight weight_through = weights[vertex_from * vertex_count_ + vertex_through];
+                    // путь через саму начальную вершину ничего не улучшит
+                    if (vertex_from == vertex_through || weight_through == INFINITE_WEIGHT) {
+                        continue;
+                    }
+                    const size_t row_from = vertex_from * vertex_count_ + to_begin;
+                    RelaxRow(weight_through, weights + row_through, prev_edges + row_through,
+                             weights + row_from, prev_edges + row_from, to_size);
+                }
             }
         }
-    
-        void RelaxRoutesInternalDataThroughVertex(size_t vertex_count, VertexId vertex_through) {
-            for (VertexId vertex_from = 0; vertex_from < vertex_count; ++vertex_from) {
-                if (const auto& route_from = routes_internal_data_[vertex_from][vertex_through]) {
-                    for (VertexId vertex_to = 0; vertex_to < vertex_count; ++vertex_to) {
-                        if (const auto& route_to = routes_internal_data_[vertex_through][vertex_to]) {
-                            RelaxRoute(vertex_from, vertex_to, *route_from, *route_to);
-                        }
+
+        // Внутренний цикл min-plus без ветвлений по непрерывным строкам, который векторизует компилятор.
+        // Строки from и through различны, поэтому указатели не пересекаются.
+        template <typename EdgeIndex>
+        static void RelaxRow(Weight weight_through,
+                             const Weight* __restrict weights_through, const EdgeIndex* __restrict prev_edges_through,
+                             Weight* __restrict weights_from, EdgeIndex* __restrict prev_edges_from, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                const Weight candidate_weight = weight_through + weights_through[i];
+                const Weight current_weight = weights_from[i];
+                const EdgeIndex candidate_edge = prev_edges_through[i];
+                const EdgeIndex current_edge = prev_edges_from[i];
+                const EdgeIndex is_better_mask = -static_cast<std::make_signed_t<EdgeIndex>>(candidate_weight < current_weight);
+                weights_from[i] = std::min(current_weight, candidate_weight);
+                prev_edges_from[i] = (candidate_edge & is_better_mask) | (current_edge & ~is_better_mask);
+            }
+        }
+
+        template <typename EdgeIndex>
+        void RelaxRoutesInternalData(RoutesInternalData<EdgeIndex>& routes, parallel::ThreadPool& thread_pool) const {
+            const size_t block_count = (vertex_count_ + BLOCK_SIZE - 1) / BLOCK_SIZE;
+            for (size_t block_through = 0; block_through < block_count; ++block_through) {
+                RelaxBlockThroughBlock(routes, block_through, block_through, block_through);
+
+                thread_pool.ParallelFor(block_count, [&](size_t block) {
+                    if (block != block_through) {
+                        RelaxBlockThroughBlock(routes, block_through, block, block_through);
+                        RelaxBlockThroughBlock(routes, block, block_through, block_through);
                     }
+                });
+
+                thread_pool.ParallelFor(block_count * block_count, [&](size_t task) {
+                    const size_t block_from = task / block_count;
+                    const size_t block_to = task % block_count;
+                    if (block_from != block_through && block_to != block_through) {
+                        RelaxBlockThroughBlock(routes, block_from, block_to, block_through);
+                    }
+                });
+            }
+        }
+
+        template <typename EdgeIndex, typename TableEdgeIndex>
+        RoutesInternalData<EdgeIndex> CopyRoutesTable(const RoutesTable<TableEdgeIndex>& table) const {
+            RoutesInternalData<EdgeIndex> routes(vertex_count_);
+            const size_t cell_count = vertex_count_ * vertex_count_;
+            std::copy(table.weights, table.weights + cell_count, routes.weights.begin());
+            std::transform(table.prev_edges, table.prev_edges + cell_count, routes.prev_edges.begin(), [](TableEdgeIndex edge_id) {
+                return edge_id == RoutesTable<TableEdgeIndex>::NO_EDGE ? RoutesTable<EdgeIndex>::NO_EDGE : static_cast<EdgeIndex>(edge_id);
+            });
+            return routes;
+        }
+
+        // Перед изменением таблицы: переданную извне таблицу копирует, а узкие номера рёбер расширяет, если они перестали помещаться
+        void MakeRoutesInternalDataWritable() {
+            const bool needs_wide = graph_.GetEdgeCount() >= CompactRoutesInternalData::NO_EDGE;
+            if (std::holds_alternative<WideRoutesInternalData>(routes_internal_data_)
+                || (std::holds_alternative<CompactRoutesInternalData>(routes_internal_data_) && !needs_wide)) {
+                return;
+            }
+            std::visit([&](const auto& table) {
+                if (needs_wide) {
+                    routes_internal_data_ = CopyRoutesTable<EdgeId>(table);
+                } else {
+                    routes_internal_data_ = CopyRoutesTable<std::uint32_t>(table);
+                }
+            }, routes_table_);
+            storage_.reset();
+        }
+
+        template <typename EdgeIndex>
+        std::optional<RouteInfo> BuildRoute(const RoutesTable<EdgeIndex>& routes, VertexId from, VertexId to) const {
+            const size_t row_from = from * vertex_count_;
+            const Weight weight = routes.weights[row_from + to];
+            if (weight == INFINITE_WEIGHT) {
+                return std::nullopt;
+            }
+            std::vector<EdgeId> edges;
+            for (EdgeIndex edge_id = routes.prev_edges[row_from + to];
+                 edge_id != RoutesTable<EdgeIndex>::NO_EDGE;
+                 edge_id = routes.prev_edges[row_from + graph_.GetEdge(edge_id).from])
+            {
+                //таблица может быть прочитана из файла, а GetEdge номер не проверяет
+                if (edge_id >= graph_.GetEdgeCount() || edges.size() >= vertex_count_) {
+                    throw std::runtime_error("Routes table is corrupted");
                 }
+                edges.push_back(edge_id);
             }
+            std::reverse(edges.begin(), edges.end());
+
+            return RouteInfo{weight, std::move(edges)};
         }
-    
-        static constexpr Weight ZERO_WEIGHT{};
+
         const Graph& graph_;
-        RoutesInternalData routes_internal_data_;
+        const size_t vertex_count_;
+        //пусто, если таблица передана извне
+        std::variant<std::monostate, CompactRoutesInternalData, WideRoutesInternalData> routes_internal_data_;
+        RoutesTableVariant routes_table_;
+        std::shared_ptr<const void> storage_;
     };
-    
+
     template <typename Weight>
-    Router<Weight>::Router(const Graph& graph)
+    Router<Weight>::Router(const Graph& graph, size_t thread_count)
         : graph_(graph)
-        , routes_internal_data_(graph.GetVertexCount(),
-                                std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+        , vertex_count_(graph.GetVertexCount())
+        , routes_internal_data_(graph.GetEdgeCount() < CompactRoutesInternalData::NO_EDGE
+                                ? decltype(routes_internal_data_){std::in_place_type<CompactRoutesInternalData>, vertex_count_}
+                                : decltype(routes_internal_data_){std::in_place_type<WideRoutesInternalData>, vertex_count_})
     {
-        InitializeRoutesInternalData(graph);
-    
-        const size_t vertex_count = graph.GetVertexCount();
-        for (VertexId vertex_through = 0; vertex_through < vertex_count; ++vertex_through) {
-            RelaxRoutesInternalDataThroughVertex(vertex_count, vertex_through);
-        }
+        parallel::ThreadPool thread_pool(thread_count);
+        std::visit([&](auto& routes) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(routes)>, std::monostate>) {
+                InitializeRoutesInternalData(graph, routes);
+                RelaxRoutesInternalData(routes, thread_pool);
+                using EdgeIndex = typename decltype(routes.prev_edges)::value_type;
+                routes_table_ = RoutesTable<EdgeIndex>{routes.weights.data(), routes.prev_edges.data()};
+            }
+        }, routes_internal_data_);
+    }
+
+    template <typename Weight>
+    Router<Weight>::Router(const Graph& graph, RoutesTableVariant routes_table, std::shared_ptr<const void> storage)
+        : graph_(graph)
+        , vertex_count_(graph.GetVertexCount())
+        , routes_table_(routes_table)
+        , storage_(std::move(storage))
+    {
+        std::visit([&](const auto& routes) {
+            if (vertex_count_ > 0 && (routes.weights == nullptr || routes.prev_edges == nullptr)) {
+                throw std::invalid_argument("Routes table is empty");
+            }
+            if (graph.GetEdgeCount() >= std::decay_t<decltype(routes)>::NO_EDGE) {
+                throw std::invalid_argument("Routes table can't index all edges");
+            }
+        }, routes_table_);
     }
-    
+
     template <typename Weight>
     std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
                                                                                  VertexId to) const {
-        const auto& route_internal_data = routes_internal_data_.at(from).at(to);
-        if (!route_internal_data) {
-            return std::nullopt;
+        if (from >= vertex_count_ || to >= vertex_count_) {
+            throw std::out_of_range("Vertex is out of range");
         }
-        const Weight weight = route_internal_data->weight;
-        std::vector<EdgeId> edges;
-        for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
-             edge_id;
-             edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
-        {
-            edges.push_back(*edge_id);
+        return std::visit([&](const auto& routes) {
+            return BuildRoute(routes, from, to);
+        }, routes_table_);
+    }
+
+    template <typename Weight>
+    typename Router<Weight>::WeightsMatrix Router<Weight>::BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                                             const std::vector<VertexId>& targets) const {
+        auto check_vertex = [this](VertexId vertex) {
+            if (vertex >= vertex_count_) {
+                throw std::out_of_range("Vertex is out of range");
+            }
+        };
+        std::for_each(sources.begin(), sources.end(), check_vertex);
+        std::for_each(targets.begin(), targets.end(), check_vertex);
+        return std::visit([&](const auto& routes) {
+            WeightsMatrix weights(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+            for (size_t i = 0; i < sources.size(); ++i) {
+                const Weight* row = routes.weights + sources[i] * vertex_count_;
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    if (row[targets[j]] != INFINITE_WEIGHT) {
+                        weights[i][j] = row[targets[j]];
+                    }
+                }
+            }
+            return weights;
+        }, routes_table_);
+    }
+
+    template <typename Weight>
+    void Router<Weight>::AddEdges(EdgeId first_edge_id, size_t thread_count) {
+        if (graph_.GetVertexCount() != vertex_count_) {
+            throw std::logic_error("Vertex count of the graph has changed");
         }
-        std::reverse(edges.begin(), edges.end());
-    
-        return RouteInfo{weight, std::move(edges)};
+        MakeRoutesInternalDataWritable();
+        std::visit([&](auto& routes) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(routes)>, std::monostate>) {
+                using EdgeIndex = typename decltype(routes.prev_edges)::value_type;
+                std::vector<VertexId> vertexes_through;
+                std::vector<bool> is_vertex_through(vertex_count_, false);
+                auto add_vertex_through = [&](VertexId vertex) {
+                    if (!is_vertex_through[vertex]) {
+                        is_vertex_through[vertex] = true;
+                        vertexes_through.push_back(vertex);
+                    }
+                };
+                for (EdgeId edge_id = first_edge_id; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+                    const auto& edge = graph_.GetEdge(edge_id);
+                    if (edge.weight < ZERO_WEIGHT) {
+                        throw std::domain_error("Edges' weights should be non-negative");
+                    }
+                    const size_t cell = edge.from * vertex_count_ + edge.to;
+                    if (routes.weights[cell] > edge.weight) {
+                        routes.weights[cell] = edge.weight;
+                        routes.prev_edges[cell] = static_cast<EdgeIndex>(edge_id);
+                        add_vertex_through(edge.from);
+                        add_vertex_through(edge.to);
+                    }
+                }
+
+                // новый кратчайший путь составлен из прежних кратчайших путей, соединённых новыми рёбрами,
+                // поэтому достаточно шагов Флойда–Уоршелла через концы новых рёбер
+                parallel::ThreadPool thread_pool(thread_count);
+                Weight* weights = routes.weights.data();
+                EdgeIndex* prev_edges = routes.prev_edges.data();
+                for (const VertexId vertex_through : vertexes_through) {
+                    const size_t row_through = vertex_through * vertex_count_;
+                    thread_pool.ParallelFor(vertex_count_, [&](size_t vertex_from) {
+                        const Weight weight_through = weights[vertex_from * vertex_count_ + vertex_through];
+                        if (vertex_from == vertex_through || weight_through == INFINITE_WEIGHT) {
+                            return;
+                        }
+                        const size_t row_from = vertex_from * vertex_count_;
+                        RelaxRow(weight_through, weights + row_through, prev_edges + row_through,
+                                 weights + row_from, prev_edges + row_from, vertex_count_);
+                    });
+                }
+                routes_table_ = RoutesTable<EdgeIndex>{routes.weights.data(), routes.prev_edges.data()};
+            }
+        }, routes_internal_data_);
+    }
+
+    template <typename Weight>
+    size_t Router<Weight>::GetRoutesInternalDataBytes() const {
+        return std::visit([&](const auto& routes) {
+            return vertex_count_ * vertex_count_ * (sizeof(Weight) + sizeof(*routes.prev_edges));
+        }, routes_table_);
+    }
+
+    template <typename Weight>
+    typename Router<Weight>::RoutesTableVariant Router<Weight>::GetRoutesTable() const {
+        return routes_table_;
     }
 
 }  // namespace graph
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "graph.h"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace graph {
+
+    // Общий интерфейс алгоритмов поиска кратчайшего пути по графу
+    template <typename Weight>
+    class RouterEngine {
+    public:
+        struct RouteInfo {
+            Weight weight;
+            std::vector<EdgeId> edges;
+            //число вершин, извлечённых из очереди при поиске (0, если поиск не понадобился)
+            size_t settled_vertices = 0;
+        };
+
+        //weights[i][j] - вес кратчайшего пути из sources[i] в targets[j], nullopt - пути нет
+        using WeightsMatrix = std::vector<std::vector<std::optional<Weight>>>;
+
+        virtual ~RouterEngine() = default;
+
+        virtual std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const = 0;
+
+        // Веса путей без восстановления самих путей. По умолчанию - отдельный поиск на каждую пару,
+        // алгоритмы, которым хватает одного поиска на источник или меньше, переопределяют метод.
+        virtual WeightsMatrix BuildWeightsMatrix(const std::vector<VertexId>& sources,
+                                                 const std::vector<VertexId>& targets) const {
+            WeightsMatrix weights(sources.size(), std::vector<std::optional<Weight>>(targets.size()));
+            for (size_t i = 0; i < sources.size(); ++i) {
+                for (size_t j = 0; j < targets.size(); ++j) {
+                    if (const auto route_info = BuildRoute(sources[i], targets[j])) {
+                        weights[i][j] = route_info->weight;
+                    }
+                }
+            }
+            return weights;
+        }
+    };
+
+    // Нижняя оценка веса пути из from в to для целенаправленного поиска
+    template <typename Weight>
+    using Heuristic = std::function<Weight(VertexId from, VertexId to)>;
+
+}  // namespace graph
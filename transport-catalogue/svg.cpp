@@ -213,4 +213,8 @@ namespace svg {
         objects_.emplace_back(std::move(obj));
     }
 
+    void Document::Clear() {
+        objects_.clear();
+    }
+
 } // namespace svg
\ No newline at end of file
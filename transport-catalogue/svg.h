@@ -330,6 +330,9 @@ namespace svg {
         // Выводит в ostream svg-представление документа
         void Render(std::ostream& out) const;
 
+        // Удаляет все объекты документа
+        void Clear();
+
         // Прочие методы и данные, необходимые для реализации класса Document
 
     private:
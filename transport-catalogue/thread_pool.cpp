@@ -0,0 +1,98 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace parallel {
+
+    ThreadPool::ThreadPool(size_t thread_count) {
+        const size_t workers_count = std::max<size_t>(thread_count, 1) - 1;
+        workers_.reserve(workers_count);
+        for (size_t i = 0; i < workers_count; ++i) {
+            workers_.emplace_back([this] { Work(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard guard(mutex_);
+            stop_ = true;
+        }
+        start_cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t ThreadPool::GetThreadCount() const noexcept {
+        return workers_.size() + 1;
+    }
+
+    void ThreadPool::ParallelFor(size_t task_count, const std::function<void(size_t)>& task) {
+        if (workers_.empty() || task_count <= 1) {
+            for (size_t i = 0; i < task_count; ++i) {
+                task(i);
+            }
+            return;
+        }
+        {
+            std::lock_guard guard(mutex_);
+            task_ = &task;
+            task_count_ = task_count;
+            next_task_ = 0;
+            active_workers_ = workers_.size();
+            ++generation_;
+        }
+        start_cv_.notify_all();
+        RunTasks();
+
+        std::exception_ptr error;
+        {
+            //рабочие потоки держат указатель на task, поэтому ждём их и при исключении
+            std::unique_lock lock(mutex_);
+            done_cv_.wait(lock, [this] { return active_workers_ == 0; });
+            task_ = nullptr;
+            error = std::exchange(error_, nullptr);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ThreadPool::Work() {
+        size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+                if (stop_) {
+                    return;
+                }
+                seen_generation = generation_;
+            }
+            RunTasks();
+            {
+                std::lock_guard guard(mutex_);
+                if (--active_workers_ == 0) {
+                    done_cv_.notify_one();
+                }
+            }
+        }
+    }
+
+    void ThreadPool::RunTasks() {
+        for (size_t i = next_task_++; i < task_count_; i = next_task_++) {
+            try {
+                (*task_)(i);
+            } catch (...) {
+                std::lock_guard guard(mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                //остальные задачи фазы уже не нужны
+                next_task_ = task_count_;
+            }
+        }
+    }
+
+}  // namespace parallel
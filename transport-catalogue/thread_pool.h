@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace parallel {
+
+    // Пул потоков для параллельного выполнения независимых задач одной фазы.
+    // Вызывающий поток тоже берёт задачи, поэтому пул из одного потока не создаёт рабочих.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency());
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        size_t GetThreadCount() const noexcept;
+
+        // Выполняет task(0) ... task(task_count - 1) и дожидается завершения всех задач.
+        // Если задача бросила исключение, оставшиеся задачи не запускаются, а первое исключение бросается отсюда
+        void ParallelFor(size_t task_count, const std::function<void(size_t)>& task);
+
+    private:
+        void Work();
+        void RunTasks();
+
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable start_cv_;
+        std::condition_variable done_cv_;
+
+        const std::function<void(size_t)>* task_ = nullptr;
+        size_t task_count_ = 0;
+        std::atomic<size_t> next_task_ = 0;
+        size_t active_workers_ = 0;
+        std::exception_ptr error_;
+        size_t generation_ = 0;
+        bool stop_ = false;
+    };
+
+}  // namespace parallel
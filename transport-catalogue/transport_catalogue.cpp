@@ -1,101 +1,482 @@
 #include "transport_catalogue.h"
+#include "thread_pool.h"
+
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
 
 
 namespace TransportCatalogue {
 
+	namespace {
+		//запас растёт вдвое: поверх монотонного ресурса каждое расширение оставляет в нём прежний буфер,
+		//и так эти буферы в сумме не больше самого массива
+		template <typename Vector>
+		void ReserveForGrowth(Vector& vector, size_t size) {
+			if (size > vector.capacity()) {
+				vector.reserve(std::max(size, vector.capacity() * 2));
+			}
+		}
+	}
+
+	TransportCatalogue::TransportCatalogue(std::pmr::memory_resource* resource)
+		: names_resource_(std::make_shared<std::pmr::monotonic_buffer_resource>(NAME_BLOCK_SIZE, resource))
+		, stop_name_to_id_(resource)
+		, stop_names_(resource)
+		, stop_coordinates_(resource)
+		, bus_name_to_id_(resource)
+		, bus_names_(resource)
+		, bus_is_roundtrip_(resource)
+		, bus_is_removed_(resource)
+		, bus_stop_offsets_(1, 0, resource)
+		, bus_stops_(resource)
+		, bus_stats_(resource)
+		, changed_stops_(resource)
+		, stop_is_changed_(resource)
+		, distance_offsets_(1, 0, resource)
+		, distances_(resource)
+		, new_distances_(resource)
+		, changes_(resource) {
+	}
+
 	void TransportCatalogue::AddStop(const std::string_view stop_name, const Geo::Coordinates& stop_coordinates) {
-		stops_.emplace_back(std::string(stop_name), stop_coordinates);
-		Stop* ptr = &stops_.back();
-		stop_name_to_stops_[ptr->name] = ptr;
+		const StopId stop = PushStop(stop_name, stop_coordinates);
+		AddChange({CatalogueChange::Type::STOP_ADDED, stop});
+	}
+
+	StopId TransportCatalogue::PushStop(std::string_view stop_name, const Geo::Coordinates& stop_coordinates) {
+		if (stop_names_.size() == std::numeric_limits<StopId>::max()) {
+			throw std::length_error("Too many stops");
+		}
+		const StopId stop = static_cast<StopId>(stop_names_.size());
+		stop_names_.push_back(StoreName(stop_name));
+		stop_coordinates_.push_back(stop_coordinates);
+		stop_is_changed_.push_back(false);
+		stop_name_to_id_.insert_or_assign(stop_names_.back(), stop);
+		stop_buses_outdated_ = true;
+		return stop;
+	}
+
+	void TransportCatalogue::SetStopCoordinates(std::string_view stop_name, const Geo::Coordinates& coordinates) {
+		const StopId stop = stop_name_to_id_.at(stop_name);
+		stop_coordinates_[stop] = coordinates;
+		MarkStopChanged(stop);
+		AddChange({CatalogueChange::Type::STOP_MOVED, stop});
 	}
 
 	void TransportCatalogue::TransportCatalogue::SetDistanceBetweenStops(std::string_view stop1_name, std::string_view stop2_name, double length) {
-		Stop* ptr1 = stop_name_to_stops_.at(stop1_name);
-		Stop* ptr2 = stop_name_to_stops_.at(stop2_name);
-		length_between_stops_[{ptr1, ptr2}] = length;
+		const StopId stop1 = stop_name_to_id_.at(stop1_name);
+		const StopId stop2 = stop_name_to_id_.at(stop2_name);
+		new_distances_.push_back({stop1, {stop2, static_cast<int>(length)}});
+		//расстояние stop1 -> stop2 используется и в обратную сторону, но любой такой автобус проходит stop1
+		MarkStopChanged(stop1);
+		AddChange({CatalogueChange::Type::DISTANCE_SET, stop1, stop2});
 	}
 
 	void TransportCatalogue::AddBus(const std::string_view bus_name,const std::vector<std::string_view>& stops, bool is_roundtrip_) {
-		buses_.emplace_back(Bus(std::string(bus_name),is_roundtrip_));
-		Bus* bus_ptr = &buses_.back();
-		bus_name_to_bus_[bus_ptr->name] = bus_ptr;
-		
-		for(auto&& stop : stops) {
-			Stop* stop_ptr = stop_name_to_stops_.at(stop);
-			bus_ptr->stops_of_the_bus.push_back(stop_ptr);
-			stop_ptr->buses_of_the_stop.insert(bus_ptr);
+		if (bus_names_.size() == std::numeric_limits<BusId>::max()) {
+			throw std::length_error("Too many buses");
 		}
+		const BusId bus = static_cast<BusId>(bus_names_.size());
+		const size_t stops_size = bus_stops_.size();
+		try {
+			for(auto&& stop : stops) {
+				bus_stops_.push_back(stop_name_to_id_.at(stop));
+			}
+		} catch (...) {
+			bus_stops_.resize(stops_size);
+			throw;
+		}
+		if (bus_name_to_id_.count(bus_name)) {
+			RemoveBus(bus_name);
+		}
+		bus_stop_offsets_.push_back(bus_stops_.size());
+		bus_names_.push_back(StoreName(bus_name));
+		bus_is_roundtrip_.push_back(is_roundtrip_);
+		bus_is_removed_.push_back(false);
+		bus_name_to_id_.insert_or_assign(bus_names_.back(), bus);
+		bus_stats_.emplace_back();
+		stop_buses_outdated_ = true;
+		AddChange({CatalogueChange::Type::BUS_ADDED, bus});
 	}
 
+	void TransportCatalogue::RemoveBus(std::string_view bus_name) {
+		const BusId bus = bus_name_to_id_.at(bus_name);
+		bus_name_to_id_.erase(bus_name);
+		bus_is_removed_[bus] = true;
+		bus_stats_[bus].reset();
+		stop_buses_outdated_ = true;
+		AddChange({CatalogueChange::Type::BUS_REMOVED, bus});
+	}
+
+	void TransportCatalogue::AddBaseRequests(const Input::BaseRequests& requests, size_t thread_count) {
+		if (requests.stops.size() > std::numeric_limits<StopId>::max() - stop_names_.size()) {
+			throw std::length_error("Too many stops");
+		}
+		if (requests.buses.size() > std::numeric_limits<BusId>::max() - bus_names_.size()) {
+			throw std::length_error("Too many buses");
+		}
+		ReserveForGrowth(stop_names_, stop_names_.size() + requests.stops.size());
+		ReserveForGrowth(stop_coordinates_, stop_coordinates_.size() + requests.stops.size());
+		ReserveForGrowth(stop_is_changed_, stop_is_changed_.size() + requests.stops.size());
+		stop_name_to_id_.reserve(stop_names_.size() + requests.stops.size());
+		for (const auto& stop : requests.stops) {
+			PushStop(stop.name, stop.coordinates);
+		}
+		//остановки уже добавлены, поэтому загрузка попадает в журнал даже при ошибке ниже
+		AddChange({CatalogueChange::Type::BASE_LOADED});
+
+		//место под номера остановок расстояний и автобусов, при ошибке откатываем
+		const size_t distances_size = new_distances_.size();
+		const size_t bus_stops_size = bus_stops_.size();
+		new_distances_.resize(distances_size + requests.distances.size());
+		std::vector<size_t> bus_stop_offsets(requests.buses.size() + 1, bus_stops_size);
+		for (size_t bus = 0; bus < requests.buses.size(); ++bus) {
+			bus_stop_offsets[bus + 1] = bus_stop_offsets[bus] + requests.buses[bus].stops.size();
+		}
+		bus_stops_.resize(bus_stop_offsets.back());
+
+		//потоков не больше, чем задач в самой длинной фазе
+		const size_t max_task_count = (std::max(requests.distances.size(), requests.buses.size()) + REQUESTS_PER_TASK - 1) / REQUESTS_PER_TASK;
+		size_t pool_size = thread_count ? thread_count : std::thread::hardware_concurrency();
+		if (requests.distances.size() + requests.buses.size() < MIN_PARALLEL_REQUESTS) {
+			pool_size = 1;
+		}
+		parallel::ThreadPool thread_pool(std::max<size_t>(1, std::min(pool_size, max_task_count)));
+		std::mutex error_mutex;
+		std::exception_ptr error;
+		auto resolve_in_parallel = [&](size_t request_count, const std::function<void(size_t)>& resolve) {
+			thread_pool.ParallelFor((request_count + REQUESTS_PER_TASK - 1) / REQUESTS_PER_TASK, [&](size_t task) {
+				try {
+					const size_t end = std::min(request_count, (task + 1) * REQUESTS_PER_TASK);
+					for (size_t i = task * REQUESTS_PER_TASK; i < end; ++i) {
+						resolve(i);
+					}
+				} catch (...) {
+					std::lock_guard guard(error_mutex);
+					if (!error) {
+						error = std::current_exception();
+					}
+				}
+			});
+		};
+		//поиск в индексе имён только читает его, поэтому безопасен из нескольких потоков
+		resolve_in_parallel(requests.distances.size(), [&](size_t i) {
+			const auto& distance = requests.distances[i];
+			new_distances_[distances_size + i] = {stop_name_to_id_.at(distance.from), {stop_name_to_id_.at(distance.to), static_cast<int>(distance.length)}};
+		});
+		resolve_in_parallel(requests.buses.size(), [&](size_t bus) {
+			size_t position = bus_stop_offsets[bus];
+			for (const std::string_view stop : requests.buses[bus].stops) {
+				bus_stops_[position++] = stop_name_to_id_.at(stop);
+			}
+		});
+		if (error) {
+			new_distances_.resize(distances_size);
+			bus_stops_.resize(bus_stops_size);
+			std::rethrow_exception(error);
+		}
+
+		const size_t bus_count = bus_names_.size() + requests.buses.size();
+		ReserveForGrowth(bus_names_, bus_count);
+		ReserveForGrowth(bus_is_roundtrip_, bus_count);
+		ReserveForGrowth(bus_is_removed_, bus_count);
+		ReserveForGrowth(bus_stop_offsets_, bus_count + 1);
+		bus_name_to_id_.reserve(bus_count);
+		for (size_t i = 0; i < requests.buses.size(); ++i) {
+			const BusId bus = static_cast<BusId>(bus_names_.size());
+			//повторное имя заменяет прежний автобус, отдельных записей в журнале не нужно
+			if (const auto it = bus_name_to_id_.find(requests.buses[i].name); it != bus_name_to_id_.end()) {
+				bus_is_removed_[it->second] = true;
+			}
+			bus_names_.push_back(StoreName(requests.buses[i].name));
+			bus_is_roundtrip_.push_back(requests.buses[i].is_roundtrip);
+			bus_is_removed_.push_back(false);
+			bus_stop_offsets_.push_back(bus_stop_offsets[i + 1]);
+			bus_name_to_id_.insert_or_assign(bus_names_.back(), bus);
+		}
+		if (requests.distances.empty()) {
+			bus_stats_.resize(bus_count);
+		} else {
+			ReserveForGrowth(bus_stats_, bus_count);
+			bus_stats_.assign(bus_count, std::nullopt);
+		}
+		UpdateStopBuses();
+		if (!new_distances_.empty()) {
+			MergeDistances();
+		}
+	}
 
 	Info::Bus TransportCatalogue::GetInfoAboutBus(std::string_view bus) const{
-		Info::Bus businfo(bus);
-		auto pos = bus_name_to_bus_.find(bus);
-		
-		if (pos == bus_name_to_bus_.end()) {
-			return businfo;
+		auto pos = bus_name_to_id_.find(bus);
 		
+		if (pos == bus_name_to_id_.end()) {
+			return Info::Bus(bus);
+		}
+		return MakeBusInfo(bus, bus_stop_offsets_[pos->second + 1] - bus_stop_offsets_[pos->second], GetBusStats(pos->second));
+	}
+
+	const BusStats& TransportCatalogue::GetBusStats(BusId bus) const {
+		if (!changed_stops_.empty()) {
+			ResetChangedBusStats();
+		}
+		auto& stats = bus_stats_[bus];
+		if (!stats) {
+			stats = ComputeBusStats(GetBus(bus).stops_of_the_bus, stop_coordinates_.data(), GetDistanceRows());
+		}
+		return *stats;
+	}
+
+	void TransportCatalogue::MarkStopChanged(StopId stop) {
+		if (!stop_is_changed_[stop]) {
+			stop_is_changed_[stop] = true;
+			changed_stops_.push_back(stop);
+		}
+	}
+
+	void TransportCatalogue::ResetChangedBusStats() const {
+		//когда изменена большая часть остановок, дешевле сбросить всё
+		if (2 * changed_stops_.size() >= stop_names_.size()) {
+			bus_stats_.assign(bus_stats_.size(), std::nullopt);
 		} else {
-			businfo.no_bus = false;
-			businfo.count_of_stops = pos->second->stops_of_the_bus.size();
-			std::set<Stop*> unique_stop(pos->second->stops_of_the_bus.begin(), pos->second->stops_of_the_bus.end());
-			businfo.count_of_unique_stops = unique_stop.size();
-			double geo_length = Geo::detail::ComputeGeoLength(pos->second->stops_of_the_bus);
-			businfo.length = ComputeRouteLength(pos->second);
-			businfo.curvature = businfo.length / geo_length;
-			return businfo;
+			for (const StopId stop : changed_stops_) {
+				for (const BusId bus : GetStop(stop).buses_of_the_stop) {
+					bus_stats_[bus].reset();
+				}
+			}
+		}
+		for (const StopId stop : changed_stops_) {
+			stop_is_changed_[stop] = false;
 		}
+		changed_stops_.clear();
 	}
 
 	Info::Stop TransportCatalogue::GetInfoAboutStop(std::string_view stop_name) const{
-		Info::Stop stop_info(stop_name);
-		auto pos = stop_name_to_stops_.find(stop_name);
+		auto pos = stop_name_to_id_.find(stop_name);
 		
-		if (pos == stop_name_to_stops_.end()) {
-			return stop_info;
+		if (pos == stop_name_to_id_.end()) {
+			return Info::Stop(stop_name);
 		}
-		stop_info.not_found = false;
-		
-		for (auto&& bus : pos->second->buses_of_the_stop){
-			stop_info.buses_on_stop.push_back(bus->name);
-			std::sort(stop_info.buses_on_stop.begin(), stop_info.buses_on_stop.end());
-		}	
-		return stop_info;
+		if (stop_buses_outdated_) {
+			UpdateStopBuses();
+		}
+		//изменения справочника собирают новые списки, а ответ держит эти
+		return MakeStopInfo(stop_name, stop_buses_, pos->second);
 	}
 
-    double TransportCatalogue::GetDistanceBetweenStops(Stop* from, Stop* to) const {
-		double result = 0.;
-		auto it = length_between_stops_.find({from, to});
-        if (it != length_between_stops_.end()) {
-			result = length_between_stops_.at({from, to});
-		} else if (length_between_stops_.find({to, from}) != length_between_stops_.end()) {
-			result = length_between_stops_.at({to, from});
-		}
-		return result;
+    double TransportCatalogue::GetDistanceBetweenStops(StopId from, StopId to) const {
+		return GetDistanceRows().GetDistance(from, to);
     }
 
-    const std::unordered_map<std::string_view, Bus *>& TransportCatalogue::GetReferenseBuses() const {
-        return bus_name_to_bus_;
+	DistanceRows TransportCatalogue::GetDistanceRows() const {
+		if (!new_distances_.empty()) {
+			MergeDistances();
+		}
+		const size_t* offsets = distance_offsets_.data();
+		return DistanceRows{{offsets, offsets + distance_offsets_.size()}, distances_.data()};
+	}
+
+    const names::NameIndex<BusId>& TransportCatalogue::GetReferenseBuses() const {
+        return bus_name_to_id_;
     }
 
-    const std::unordered_map<std::string_view, Stop *>& TransportCatalogue::GetReferenseStops() const {
-        return stop_name_to_stops_;
+    const names::NameIndex<StopId>& TransportCatalogue::GetReferenseStops() const {
+        return stop_name_to_id_;
     }
 
-    double TransportCatalogue::ComputeRouteLength(const Bus* bus) const {		
+	size_t TransportCatalogue::GetStopCount() const {
+		return stop_names_.size();
+	}
+
+	size_t TransportCatalogue::GetBusCount() const {
+		return bus_names_.size();
+	}
+
+	Stop TransportCatalogue::GetStop(StopId stop) const {
+		if (stop_buses_outdated_) {
+			UpdateStopBuses();
+		}
+		const BusId* buses = stop_buses_->buses.data();
+		return Stop{stop, stop_names_.at(stop), stop_coordinates_[stop],
+					{buses + stop_buses_->offsets[stop], buses + stop_buses_->offsets[stop + 1]}};
+	}
+
+	Bus TransportCatalogue::GetBus(BusId bus) const {
+		const StopId* stops = bus_stops_.data();
+		const size_t stops_end = bus_is_removed_.at(bus) ? bus_stop_offsets_[bus] : bus_stop_offsets_[bus + 1];
+		return Bus{bus, bus_names_[bus], {stops + bus_stop_offsets_[bus], stops + stops_end}, bus_is_roundtrip_[bus]};
+	}
+
+	bool TransportCatalogue::IsBusRemoved(BusId bus) const {
+		return bus_is_removed_.at(bus);
+	}
+
+	std::uint64_t TransportCatalogue::GetVersion() const {
+		return changes_base_ + changes_.size();
+	}
+
+	std::optional<ranges::Range<const CatalogueChange*>> TransportCatalogue::GetChangesSince(std::uint64_t version) const {
+		if (version > GetVersion()) {
+			throw std::out_of_range("Catalogue version is ahead of the catalogue");
+		}
+		if (version < changes_base_) {
+			return std::nullopt;
+		}
+		const CatalogueChange* changes = changes_.data();
+		return ranges::Range<const CatalogueChange*>{changes + (version - changes_base_), changes + changes_.size()};
+	}
+
+	void TransportCatalogue::AddChange(CatalogueChange change) {
+		if (changes_.size() >= std::max(MAX_JOURNAL_SIZE, stop_names_.size() + bus_names_.size())) {
+			const size_t dropped = changes_.size() / 2;
+			changes_.erase(changes_.begin(), changes_.begin() + dropped);
+			changes_base_ += dropped;
+		}
+		changes_.push_back(change);
+	}
+
+    double TransportCatalogue::ComputeRouteLength(BusId bus) const {		
 		double result = 0;
-		size_t end_of_calculating = static_cast<int>(bus->stops_of_the_bus.size()) - 1;
-			for(size_t i = 0; i < end_of_calculating;) {
-				Stop* stop1 = bus->stops_of_the_bus[i];
-				Stop* stop2 = bus->stops_of_the_bus[++i];
-				result += GetDistanceBetweenStops(stop1, stop2);
+		const auto stops = GetBus(bus).stops_of_the_bus;
+		const DistanceRows distances = GetDistanceRows();
+			for(size_t i = 1; i < stops.size(); ++i) {
+				result += distances.GetDistance(stops[i - 1], stops[i]);
 			}
 		return result;
 	}
 
-    
-}
+	std::shared_ptr<const CatalogueSnapshot> TransportCatalogue::Freeze() const {
+		//снимок берёт готовую статистику из bus_stats_, поэтому сначала сбрасываем устаревшую
+		if (!changed_stops_.empty()) {
+			ResetChangedBusStats();
+		}
+		return std::make_shared<const CatalogueSnapshot>(*this);
+	}
 
+	std::string_view TransportCatalogue::StoreName(std::string_view name) {
+		if (name.empty()) {
+			return {};
+		}
+		char* data = static_cast<char*>(names_resource_->allocate(name.size(), alignof(char)));
+		std::memcpy(data, name.data(), name.size());
+		return {data, name.size()};
+	}
 
+	// Два прохода по остановкам автобусов: подсчёт и заполнение. Автобус, проходящий остановку
+	// несколько раз, записывается у неё один раз, удалённые автобусы пропускаются. Затем автобусы каждой остановки сортируются по имени.
+	// Прежние списки не трогаем: их могут держать снимки и ответы Stop
+	void TransportCatalogue::UpdateStopBuses() const {
+		const size_t stop_count = stop_names_.size();
+		constexpr BusId NO_BUS = std::numeric_limits<BusId>::max();
+		std::vector<BusId> last_bus(stop_count, NO_BUS);
+		auto stop_buses = std::make_shared<StopBuses>();
+		auto& offsets = stop_buses->offsets;
+		auto& buses = stop_buses->buses;
+		offsets.assign(stop_count + 1, 0);
+		for (BusId bus = 0; bus < bus_names_.size(); ++bus) {
+			if (bus_is_removed_[bus]) {
+				continue;
+			}
+			for (size_t i = bus_stop_offsets_[bus]; i < bus_stop_offsets_[bus + 1]; ++i) {
+				const StopId stop = bus_stops_[i];
+				if (last_bus[stop] != bus) {
+					last_bus[stop] = bus;
+					++offsets[stop + 1];
+				}
+			}
+		}
+		for (size_t stop = 0; stop < stop_count; ++stop) {
+			offsets[stop + 1] += offsets[stop];
+		}
+		buses.resize(offsets[stop_count]);
+		std::vector<size_t> positions(offsets.begin(), std::prev(offsets.end()));
+		std::fill(last_bus.begin(), last_bus.end(), NO_BUS);
+		for (BusId bus = 0; bus < bus_names_.size(); ++bus) {
+			if (bus_is_removed_[bus]) {
+				continue;
+			}
+			for (size_t i = bus_stop_offsets_[bus]; i < bus_stop_offsets_[bus + 1]; ++i) {
+				const StopId stop = bus_stops_[i];
+				if (last_bus[stop] != bus) {
+					last_bus[stop] = bus;
+					buses[positions[stop]++] = bus;
+				}
+			}
+		}
+		stop_buses->names.resize(buses.size());
+		for (size_t stop = 0; stop < stop_count; ++stop) {
+			const auto row_begin = buses.begin() + offsets[stop];
+			const auto row_end = buses.begin() + offsets[stop + 1];
+			std::sort(row_begin, row_end, [this](BusId lhs, BusId rhs) {
+				return bus_names_[lhs] < bus_names_[rhs];
+			});
+			for (size_t i = offsets[stop]; i < offsets[stop + 1]; ++i) {
+				stop_buses->names[i] = bus_names_[buses[i]];
+			}
+		}
+		stop_buses->names_storage = names_resource_;
+		stop_buses_ = std::move(stop_buses);
+		stop_buses_outdated_ = false;
+	}
 
+	// Новые расстояния сортируются по (from, to), из повторно заданных остаётся последнее, а уже известные
+	// обновляются в строке. Остальные вливаются проходом с конца массива: строка сдвигается на число новых
+	// расстояний в ней и перед ней, поэтому строки до первой изменённой остаются на месте
+	void TransportCatalogue::MergeDistances() const {
+		std::stable_sort(new_distances_.begin(), new_distances_.end(), [](const auto& lhs, const auto& rhs) {
+			return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second.to < rhs.second.to);
+		});
+		size_t new_count = 0;
+		for (size_t i = 0; i < new_distances_.size(); ++i) {
+			const auto& [from, distance] = new_distances_[i];
+			if (i + 1 < new_distances_.size() && new_distances_[i + 1].first == from && new_distances_[i + 1].second.to == distance.to) {
+				continue;
+			}
+			if (from + 1 < distance_offsets_.size()) {
+				const auto row_end = distances_.begin() + distance_offsets_[from + 1];
+				const auto it = std::lower_bound(distances_.begin() + distance_offsets_[from], row_end, distance.to,
+												 [](const RoadDistance& row_distance, StopId stop) { return row_distance.to < stop; });
+				if (it != row_end && it->to == distance.to) {
+					it->length = distance.length;
+					continue;
+				}
+			}
+			new_distances_[new_count++] = new_distances_[i];
+		}
+		new_distances_.resize(new_count);
+		if (new_count == 0) {
+			return;
+		}
 
+		if (distance_offsets_.size() < new_distances_.back().first + size_t{2}) {
+			distance_offsets_.resize(new_distances_.back().first + size_t{2}, distance_offsets_.back());
+		}
+		ReserveForGrowth(distances_, distances_.size() + new_count);
+		distances_.resize(distances_.size() + new_count);
+		//pending - новые расстояния из строк не дальше текущей
+		size_t pending = new_count;
+		for (size_t row = distance_offsets_.size() - 1; pending > 0;) {
+			--row;
+			const size_t row_begin = distance_offsets_[row];
+			size_t read = distance_offsets_[row + 1];
+			distance_offsets_[row + 1] += pending;
+			size_t write = distance_offsets_[row + 1];
+			while (pending > 0 && new_distances_[pending - 1].first == row) {
+				const RoadDistance& distance = new_distances_[pending - 1].second;
+				if (read > row_begin && distances_[read - 1].to > distance.to) {
+					distances_[--write] = distances_[--read];
+				} else {
+					distances_[--write] = distance;
+					--pending;
+				}
+			}
+			std::move_backward(distances_.begin() + row_begin, distances_.begin() + read, distances_.begin() + write);
+		}
+		new_distances_.clear();
+	}
+    
+}
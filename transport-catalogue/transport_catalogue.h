@@ -1,62 +1,203 @@
 #pragma once
 
+#include "catalogue_data.h"
+#include "catalogue_snapshot.h"
 #include "domain.h"
 #include "geo.h"
+#include "name_index.h"
 
 #include <algorithm>
-#include <deque>
+#include <cstdint>
 #include <iostream>
-#include <set>
+#include <memory>
+#include <memory_resource>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
 #include <vector>
 
 
 namespace TransportCatalogue {
+
+	namespace Input {
+
+		struct StopRequest {
+			std::string_view name;
+			Geo::Coordinates coordinates = {0, 0};
+		};
+
+		struct DistanceRequest {
+			std::string_view from;
+			std::string_view to;
+			double length = 0.;
+		};
+
+		struct BusRequest {
+			std::string_view name;
+			//для некольцевого автобуса - путь туда и обратно
+			std::vector<std::string_view> stops;
+			bool is_roundtrip = false;
+		};
+
+		// Все базовые запросы сразу, имена должны жить до конца загрузки
+		struct BaseRequests {
+			std::vector<StopRequest> stops;
+			std::vector<DistanceRequest> distances;
+			std::vector<BusRequest> buses;
+		};
+	}
+
+	// Запись журнала изменений справочника. Номер версии справочника - число всех когда-либо сделанных записей,
+	// поэтому зависимые данные запоминают версию, с которой собраны, и дочитывают журнал с неё.
+	// Старые записи журнал отбрасывает: отставшим от него зависимым данным остаётся собраться заново
+	struct CatalogueChange {
+		enum class Type : std::uint8_t {
+			//загрузка AddBaseRequests: зависимые данные собираются заново
+			BASE_LOADED,
+			STOP_ADDED,
+			STOP_MOVED,
+			//id - остановка from
+			DISTANCE_SET,
+			BUS_ADDED,
+			BUS_REMOVED
+		};
+
+		Type type = Type::BASE_LOADED;
+		//номер остановки или автобуса
+		std::uint32_t id = 0;
+		//для DISTANCE_SET - остановка to
+		StopId to = 0;
+	};
 	
 
+	// Остановки и автобусы получают плотные номера в порядке добавления, их данные лежат в непрерывных массивах.
+	// Stop и Bus - лёгкие представления этих массивов, действительные до следующего изменения справочника.
+	// Вся память справочника берётся из resource, имена - блоками через монотонный ресурс поверх него.
+	// Если resource сам монотонный (арена), справочник освобождается вместе с ней одним действием,
+	// но буферы, из которых массивы выросли при правках и ленивых пересборках, остаются в арене до конца.
+	// Массивы растут вдвое, поэтому такие буферы занимают не больше самих массивов; арена подходит справочнику,
+	// который загружается один раз, а для долгой работы с частыми правками лучше ресурс по умолчанию.
+	// Имена делятся со снимками и ответами Stop и живут, пока те на них ссылаются, поэтому resource должен пережить
+	// и их. Списки автобусов остановок каждая пересборка кладёт в новый буфер, поэтому они лежат в общей куче.
+	// Каждое изменение увеличивает версию справочника и записывается в журнал, по которому зависимые данные
+	// (статистика автобусов, граф маршрутизатора, карта) при следующем обращении пересобирают только затронутое.
 	class TransportCatalogue {
 		
 
 	public:
+		explicit TransportCatalogue(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+		TransportCatalogue(const TransportCatalogue&) = delete;
+		TransportCatalogue& operator=(const TransportCatalogue&) = delete;
+
 		void AddStop(const std::string_view stop_name, const Geo::Coordinates& coordinates);
 		void SetDistanceBetweenStops(std::string_view stop1_name, std::string_view stop2_name, double length);
+		// Автобус с уже существующим именем заменяет прежний
 		void AddBus(const std::string_view bus_name,const std::vector<std::string_view>& stops, bool is_roundtrip_);
+		// Номер удалённого автобуса не переиспользуется, его представление Bus остаётся без остановок.
+		// Бросает out_of_range, если автобуса нет
+		void RemoveBus(std::string_view bus_name);
+		void SetStopCoordinates(std::string_view stop_name, const Geo::Coordinates& coordinates);
+		// Загружает остановки, расстояния и автобусы разом: место резервируется заранее, имена остановок
+		// в расстояниях и автобусах переводятся в номера параллельно кусками на thread_count потоках (0 - по числу ядер;
+		// небольшие загрузки - в вызывающем потоке),
+		// списки автобусов остановок и строки расстояний собираются один раз в конце.
+		// Если остановка не найдена, бросает out_of_range; остановки к этому моменту добавлены, расстояния и автобусы - нет
+		void AddBaseRequests(const Input::BaseRequests& requests, size_t thread_count = 0);
+
+		//имя -> номер
+		const names::NameIndex<BusId>& GetReferenseBuses() const;
+		const names::NameIndex<StopId>& GetReferenseStops() const;
 
-		const std::unordered_map<std::string_view, Bus*>& GetReferenseBuses() const;
-		const std::unordered_map<std::string_view, Stop*>& GetReferenseStops() const;
+		size_t GetStopCount() const;
+		//вместе с удалёнными автобусами
+		size_t GetBusCount() const;
+		bool IsBusRemoved(BusId bus) const;
+		Stop GetStop(StopId stop) const;
+		Bus GetBus(BusId bus) const;
 		
-		double ComputeRouteLength(const Bus* bus) const;
+		double ComputeRouteLength(BusId bus) const;
 		Info::Bus GetInfoAboutBus (std::string_view bus) const;
 		Info::Stop GetInfoAboutStop (std::string_view stop) const;
-		double GetDistanceBetweenStops(Stop* from, Stop* to) const;
+		double GetDistanceBetweenStops(StopId from, StopId to) const;
+
+		std::uint64_t GetVersion() const;
+		// Изменения после версии version, действительны до следующего изменения справочника.
+		// nullopt, если часть этих изменений уже отброшена из журнала. Бросает out_of_range, если такой версии ещё нет
+		std::optional<ranges::Range<const CatalogueChange*>> GetChangesSince(std::uint64_t version) const;
+
+		// Собирает неизменяемый снимок текущих данных для параллельных читателей.
+		// Сам справочник не потокобезопасен: Freeze нельзя вызывать одновременно с другими его методами
+		std::shared_ptr<const CatalogueSnapshot> Freeze() const;
 
 	private:
+		friend class CatalogueSnapshot;
 
-		class StopsPtrHasher {
-		public:
-		size_t operator()(const std::pair<Stop*,Stop*> stops_ptr_pair) const {
-			std::hash<const void*> hasher;
-			const int q = 37;
-			size_t hash = (hasher(stops_ptr_pair.first) / q ) + (hasher(stops_ptr_pair.second) * q);
-			return hash;
-		}
-		};
 
-		//имя остановки -> Stop_ptr
-		std::unordered_map<std::string_view, Stop*> stop_name_to_stops_;
-		//остановки
-		std::deque<Stop> stops_;
-		//имя автобуса -> Bus_ptr
-		std::unordered_map<std::string_view, Bus*> bus_name_to_bus_;
-		//автобусы
-		std::deque<Bus> buses_;
-		//расстояния между остановками
-		std::unordered_map<std::pair<Stop*, Stop*>, int, StopsPtrHasher> length_between_stops_;
-		
-	};
-}
+		//статистика автобуса из bus_stats_, недостающая считается и запоминается
+		const BusStats& GetBusStats(BusId bus) const;
+		//записывает изменение в журнал и отбрасывает старую половину журнала, когда он длиннее MAX_JOURNAL_SIZE
+		//и числа остановок и автобусов: столько изменений дешевле применить полной пересборкой
+		void AddChange(CatalogueChange change);
+		//добавляет остановку без записи в журнал
+		StopId PushStop(std::string_view stop_name, const Geo::Coordinates& coordinates);
+		//запоминает остановку, статистику автобусов через которую нужно сбросить; каждую - один раз
+		void MarkStopChanged(StopId stop);
+		//сбрасывает статистику автобусов, проходящих через изменённые остановки
+		void ResetChangedBusStats() const;
+		//копирует имя в монотонный ресурс, который не перемещает память, поэтому string_view на имя не устаревает
+		std::string_view StoreName(std::string_view name);
+		//собирает списки автобусов остановок в новом буфере после изменения автобусов
+		void UpdateStopBuses() const;
+		//вливает новые расстояния в отсортированные строки на месте, строки до первой изменённой не трогает
+		void MergeDistances() const;
+		//строки расстояний с уже влитыми новыми расстояниями
+		DistanceRows GetDistanceRows() const;
+
+		static constexpr size_t NAME_BLOCK_SIZE = 64 * 1024;
+		//число расстояний или автобусов в одной задаче пула при загрузке
+		static constexpr size_t REQUESTS_PER_TASK = 1024;
+		//при меньшем числе расстояний и автобусов запуск потоков дороже самого перевода имён
+		static constexpr size_t MIN_PARALLEL_REQUESTS = 16 * REQUESTS_PER_TASK;
+		static constexpr size_t MAX_JOURNAL_SIZE = 4096;
+		//общий со снимками и списками автобусов остановок
+		std::shared_ptr<std::pmr::monotonic_buffer_resource> names_resource_;
+
+		//имя остановки -> номер
+		names::NameIndex<StopId> stop_name_to_id_;
+		//остановки: номер остановки - индекс в массивах
+		std::pmr::vector<std::string_view> stop_names_;
+		std::pmr::vector<Geo::Coordinates> stop_coordinates_;
+		//автобусы остановок по алфавиту; строятся по остановкам автобусов при первом обращении после изменений
+		mutable std::shared_ptr<const StopBuses> stop_buses_;
+		mutable bool stop_buses_outdated_ = true;
 
+		//имя автобуса -> номер
+		names::NameIndex<BusId> bus_name_to_id_;
+		//автобусы: номер автобуса - индекс в массивах
+		std::pmr::vector<std::string_view> bus_names_;
+		std::pmr::vector<bool> bus_is_roundtrip_;
+		std::pmr::vector<bool> bus_is_removed_;
+		//остановки автобуса bus: bus_stops_[bus_stop_offsets_[bus]..bus_stop_offsets_[bus + 1])
+		std::pmr::vector<size_t> bus_stop_offsets_;
+		std::pmr::vector<StopId> bus_stops_;
+		//статистика автобусов считается при первом запросе Bus; у автобусов, проходящих через остановки
+		//с новыми расстояниями или координатами (changed_stops_), сбрасывается при следующем запросе или Freeze.
+		//Отметка в stop_is_changed_ не даёт записать остановку в changed_stops_ дважды
+		mutable std::pmr::vector<std::optional<BusStats>> bus_stats_;
+		mutable std::pmr::vector<StopId> changed_stops_;
+		mutable std::pmr::vector<bool> stop_is_changed_;
 
+		//расстояния от остановки from: distances_[distance_offsets_[from]..distance_offsets_[from + 1]),
+		//отсортированы по to; у остановок без расстояний строки в конце может не быть.
+		//Заданные после последнего чтения расстояния (остановка from и расстояние) ждут в new_distances_
+		mutable std::pmr::vector<size_t> distance_offsets_;
+		mutable std::pmr::vector<RoadDistance> distances_;
+		mutable std::pmr::vector<std::pair<StopId, RoadDistance>> new_distances_;
 
+		//записи журнала начиная с версии changes_base_
+		std::pmr::vector<CatalogueChange> changes_;
+		std::uint64_t changes_base_ = 0;
+
+	};
+}
@@ -1,68 +1,822 @@
 #include "transport_router.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
 // Вставьте сюда решение из предыдущего спринта
 
 namespace TransportCatalogue{
     namespace Router{
+
+        namespace {
+            // Файл данных маршрутизации: заголовок, остановки с вершинами, топология рёбер с описанием участков,
+            // имена остановок и автобусов, затем матрицы весов и последних рёбер таблицы маршрутов.
+            // Секции выровнены на 8 байт, чтобы таблицу можно было читать прямо из отображённого в память файла.
+            // Числа записаны в порядке байтов машины, на которой файл построен.
+            constexpr char ROUTING_DATA_MAGIC[8] = {'T', 'C', 'R', 'O', 'U', 'T', 'E', '\0'};
+            constexpr std::uint32_t ROUTING_DATA_VERSION = 2;
+            constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+            constexpr size_t SECTION_ALIGNMENT = 8;
+
+            struct RoutingDataHeader {
+                char magic[8];
+                std::uint32_t version;
+                std::uint32_t byte_order_mark;
+                std::uint64_t fingerprint;
+                std::uint64_t vertex_count;
+                std::uint64_t edge_count;
+                std::uint64_t stop_count;
+                std::uint64_t names_size;
+                std::uint32_t weight_size;
+                std::uint32_t edge_index_size;
+            };
+
+            struct StopRecord {
+                std::uint64_t name_offset;
+                std::uint64_t name_size;
+                std::uint64_t portal;
+                std::uint64_t hub;
+            };
+
+            enum class EdgeKind : std::uint32_t {
+                WAIT,
+                BUS
+            };
+
+            struct EdgeRecord {
+                std::uint64_t from;
+                std::uint64_t to;
+                double distance;
+                std::uint64_t name_offset;
+                std::uint64_t name_size;
+                EdgeKind kind;
+                std::int32_t span_count;
+            };
+
+            static_assert(std::is_trivially_copyable_v<RoutingDataHeader> && sizeof(RoutingDataHeader) % SECTION_ALIGNMENT == 0);
+            static_assert(std::is_trivially_copyable_v<StopRecord> && sizeof(StopRecord) % SECTION_ALIGNMENT == 0);
+            static_assert(std::is_trivially_copyable_v<EdgeRecord> && sizeof(EdgeRecord) % SECTION_ALIGNMENT == 0);
+
+            size_t AlignSection(size_t size) {
+                return (size + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+            }
+
+            template <typename Record>
+            Record ReadRecord(const char* data, size_t index) {
+                Record record;
+                std::memcpy(&record, data + index * sizeof(Record), sizeof(Record));
+                return record;
+            }
+
+            // FNV-1a
+            class Fingerprint {
+            public:
+                void AddBytes(const void* data, size_t size) {
+                    const auto* bytes = static_cast<const unsigned char*>(data);
+                    for (size_t i = 0; i < size; ++i) {
+                        hash_ = (hash_ ^ bytes[i]) * FNV_PRIME;
+                    }
+                }
+
+                template <typename Value>
+                void AddValue(Value value) {
+                    static_assert(std::is_trivially_copyable_v<Value>);
+                    AddBytes(&value, sizeof(value));
+                }
+
+                void AddString(std::string_view str) {
+                    AddValue(str.size());
+                    AddBytes(str.data(), str.size());
+                }
+
+                std::uint64_t Get() const {
+                    return hash_;
+                }
+
+            private:
+                static constexpr std::uint64_t FNV_PRIME = 1099511628211ull;
+                std::uint64_t hash_ = 14695981039346656037ull;
+            };
+        }
         
-        TransportRouter::TransportRouter(TransportCatalogue &catalogue) : catalogue_(catalogue) {
+        TransportRouter::TransportRouter(TransportCatalogue &catalogue) : catalogue_(catalogue)
+                                                                         , route_cache_(std::make_unique<RouteCache>()) {
         }
         void TransportRouter::SetSettings(Info::Router::RoutingSettings &settings) {
             settings_ = std::move(settings);
+            //топология собрана по устаревшей версии справочника
+            if (catalogue_version_ != catalogue_.GetVersion()) {
+                has_topology_ = false;
+            }
+            Build();
+        }
+
+        void TransportRouter::Build() {
+            catalogue_version_ = catalogue_.GetVersion();
+            route_cache_ = std::make_unique<RouteCache>(settings_.route_cache_bytes);
+            if (settings_.router_type == Info::Router::RouterType::RAPTOR) {
+                router_.reset();
+                pareto_router_.reset();
+                SetRaptorRouter();
+                return;
+            }
+            raptor_router_.reset();
+            const bool use_routing_data_file = settings_.router_type == Info::Router::RouterType::ALL_PAIRS
+                                            && !settings_.routing_data_file.empty();
+            if (use_routing_data_file && LoadRoutingData()) {
+                return;
+            }
+            if (!has_topology_) {
+                BuildTopology();
+            }
             SetGraph();
-            router_ = std::make_unique<graph::Router<Minutes>>(graph_);
+            SetRouter();
+            if (use_routing_data_file) {
+                UpdateRoutingDataFile();
+            }
+        }
+
+        void TransportRouter::UpdateRoutingDataFile() const {
+            //маршрутизатор уже построен в памяти, поэтому без файла работаем дальше
+            if (!SaveRoutingData()) {
+                std::cerr << "Warning: can't write routing data file " << settings_.routing_data_file << std::endl;
+            }
+        }
+
+        void TransportRouter::ApplyCatalogueChanges() {
+            const auto changes = catalogue_.GetChangesSince(catalogue_version_);
+            //пока маршрутизатор не собран, всё соберёт SetSettings
+            if ((changes && changes->empty()) || (!router_ && !raptor_router_)) {
+                return;
+            }
+            route_cache_->Clear();
+            //журнал уже отбросил часть изменений или топологии нет - собираем заново
+            if (!changes || (!raptor_router_ && !has_topology_)) {
+                has_topology_ = false;
+                Build();
+                return;
+            }
+
+            std::vector<StopId> new_stops;
+            //автобусы, которые добавляются заново, и имена автобусов, чьи рёбра убираются
+            std::vector<BusId> changed_buses;
+            std::vector<std::string_view> removed_buses;
+            bool stops_moved = false;
+            for (const CatalogueChange& change : *changes) {
+                switch (change.type) {
+                    case CatalogueChange::Type::BASE_LOADED:
+                        has_topology_ = false;
+                        Build();
+                        return;
+                    case CatalogueChange::Type::STOP_ADDED:
+                        new_stops.push_back(change.id);
+                        break;
+                    case CatalogueChange::Type::STOP_MOVED:
+                        stops_moved = true;
+                        break;
+                    case CatalogueChange::Type::DISTANCE_SET:
+                        //время перегона меняется у автобусов, проходящих остановку from
+                        for (const BusId bus : catalogue_.GetStop(change.id).buses_of_the_stop) {
+                            changed_buses.push_back(bus);
+                            removed_buses.push_back(catalogue_.GetBus(bus).name);
+                        }
+                        break;
+                    case CatalogueChange::Type::BUS_ADDED:
+                        changed_buses.push_back(change.id);
+                        break;
+                    case CatalogueChange::Type::BUS_REMOVED:
+                        removed_buses.push_back(catalogue_.GetBus(change.id).name);
+                        break;
+                }
+            }
+            std::sort(changed_buses.begin(), changed_buses.end());
+            changed_buses.erase(std::unique(changed_buses.begin(), changed_buses.end()), changed_buses.end());
+            changed_buses.erase(std::remove_if(changed_buses.begin(), changed_buses.end(), [this](BusId bus) {
+                return catalogue_.IsBusRemoved(bus);
+            }), changed_buses.end());
+            std::sort(removed_buses.begin(), removed_buses.end());
+            removed_buses.erase(std::unique(removed_buses.begin(), removed_buses.end()), removed_buses.end());
+            catalogue_version_ = catalogue_.GetVersion();
+
+            if (raptor_router_) {
+                for (const std::string_view bus_name : removed_buses) {
+                    raptor_router_->RemoveLines(bus_name);
+                }
+                for (const StopId stop : new_stops) {
+                    const std::string_view stop_name = catalogue_.GetStop(stop).name;
+                    if (!raptor_router_->HasStop(stop_name)) {
+                        raptor_router_->AddStop(stop_name);
+                    }
+                }
+                for (const BusId bus : changed_buses) {
+                    AddBusToRaptorRouter(catalogue_.GetBus(bus));
+                }
+                //топология графа устарела и будет построена заново при переходе на алгоритм на графе
+                has_topology_ = false;
+                return;
+            }
+
+            const size_t vertex_count = counter_;
+            const bool has_removed = RemoveBusesFromTopology(removed_buses);
+            const graph::EdgeId first_edge_id = edges_.size();
+            for (const StopId stop : new_stops) {
+                const std::string_view stop_name = catalogue_.GetStop(stop).name;
+                if (!vertexes_.count(stop_name)) {
+                    AddStopToTopology(stop_name, stop);
+                }
+            }
+            for (const BusId bus : changed_buses) {
+                AddBusToTopology(catalogue_.GetBus(bus));
+            }
+            if (has_removed || edges_.size() != first_edge_id) {
+                SetGraph();
+                // при тех же вершинах таблица всех пар дополняется новыми рёбрами, остальные алгоритмы строятся заново
+                if (settings_.router_type == Info::Router::RouterType::ALL_PAIRS && !has_removed && counter_ == vertex_count) {
+                    dynamic_cast<graph::Router<Minutes>&>(*router_).AddEdges(first_edge_id, GetRouterThreads());
+                } else {
+                    SetRouter();
+                }
+                //иначе файл устареет, и при следующем запуске таблица будет построена заново
+                if (settings_.router_type == Info::Router::RouterType::ALL_PAIRS && !settings_.routing_data_file.empty()) {
+                    UpdateRoutingDataFile();
+                }
+            } else if (stops_moved && (settings_.router_type == Info::Router::RouterType::ASTAR
+                                       || settings_.router_type == Info::Router::RouterType::BIDIRECTIONAL)) {
+                //веса рёбер от координат не зависят, меняется только нижняя оценка времени
+                SetMinutesPerMetr();
+            }
+        }
+
+        bool TransportRouter::RemoveBusesFromTopology(const std::vector<std::string_view>& bus_names) {
+            std::vector<bool> is_removed(edges_.size(), false);
+            bool has_removed = false;
+            for (const std::string_view bus_name : bus_names) {
+                const auto bus_edges_it = bus_to_edges_.find(bus_name);
+                if (bus_edges_it == bus_to_edges_.end()) {
+                    continue;
+                }
+                for (const graph::EdgeId edge_id : bus_edges_it->second) {
+                    is_removed[edge_id] = true;
+                }
+                bus_to_edges_.erase(bus_edges_it);
+                has_removed = true;
+            }
+            if (!has_removed) {
+                return false;
+            }
+
+            // номера рёбер остаются плотными: оставшиеся рёбра сдвигаются
+            std::vector<graph::EdgeId> new_edge_ids(edges_.size());
+            graph::EdgeId new_edge_id = 0;
+            for (graph::EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+                if (is_removed[edge_id]) {
+                    continue;
+                }
+                new_edge_ids[edge_id] = new_edge_id;
+                edges_[new_edge_id] = edges_[edge_id];
+                edge_labels_[new_edge_id] = edge_labels_[edge_id];
+                ++new_edge_id;
+            }
+            edges_.resize(new_edge_id);
+            edge_labels_.resize(new_edge_id);
+            for (auto& [name, bus_edges] : bus_to_edges_) {
+                for (graph::EdgeId& edge_id : bus_edges) {
+                    edge_id = new_edge_ids[edge_id];
+                }
+            }
+            return true;
         }
 
         Info::Route TransportRouter::GetRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to) const {
-            Info::Route result;
+            CheckCatalogueVersion();
+            if (settings_.route_cache_bytes == 0) {
+                return ComputeRouteInfo(pair_stop_from_to);
+            }
+            const auto& stops = catalogue_.GetReferenseStops();
+            const StopsPair stops_from_to = {stops.at(pair_stop_from_to.first), stops.at(pair_stop_from_to.second)};
+            //из кэша ответ возвращается с числом вершин, обработанных при его поиске
+            if (const auto cached_route = route_cache_->Get(stops_from_to)) {
+                return **cached_route;
+            }
+            Info::Route result = ComputeRouteInfo(pair_stop_from_to);
+            const size_t route_bytes = sizeof(Info::Route) + result.items_.size() * sizeof(decltype(result.items_)::value_type);
+            route_cache_->Put(stops_from_to, std::make_shared<const Info::Route>(result), route_bytes);
+            return result;
+        }
+
+        Info::Route TransportRouter::ComputeRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to) const {
+            if (raptor_router_) {
+                return raptor_router_->GetRouteInfo(pair_stop_from_to);
+            }
             auto stop_from = vertexes_.at(pair_stop_from_to.first).portal;
             auto stop_to = vertexes_.at(pair_stop_from_to.second).portal;
 
             auto route_info = router_->BuildRoute(stop_from, stop_to);
 
-            if(route_info) {
-                result.not_found = false;
-                result.total_time = route_info->weight;
-                for (const auto& edge_id : route_info->edges) {
-                    if(id_to_wait_info_.count(edge_id)) {
-                        result.items_.emplace_back(id_to_wait_info_.at(edge_id));
-                    } else if (id_to_bus_route_info.count(edge_id)) {
-                        result.items_.emplace_back(id_to_bus_route_info.at(edge_id));
-                    }
+            if(!route_info) {
+                return {};
+            }
+            Info::Route result = MakeRouteInfo(route_info->weight, route_info->edges);
+            result.settled_vertices = route_info->settled_vertices;
+            return result;
+        }
+
+        Info::Route TransportRouter::GetRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to, size_t max_transfers) const {
+            auto routes = GetParetoRoutesInfo(pair_stop_from_to, max_transfers).routes;
+            //первый маршрут самый быстрый
+            return routes.empty() ? Info::Route{} : std::move(routes.front());
+        }
+
+        Info::ParetoRoutes TransportRouter::GetParetoRoutesInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to,
+                                                                std::optional<size_t> max_transfers) const {
+            CheckCatalogueVersion();
+            //пересадок на одну меньше, чем посадок
+            const size_t max_boardings = max_transfers && *max_transfers < std::numeric_limits<size_t>::max() ? *max_transfers + 1 : std::numeric_limits<size_t>::max();
+            if (raptor_router_) {
+                return raptor_router_->GetParetoRoutesInfo(pair_stop_from_to, max_boardings);
+            }
+            auto stop_from = vertexes_.at(pair_stop_from_to.first).portal;
+            auto stop_to = vertexes_.at(pair_stop_from_to.second).portal;
+
+            Info::ParetoRoutes result;
+            for (const auto& route_info : pareto_router_->BuildRoutes(stop_from, stop_to, max_boardings)) {
+                result.routes.push_back(MakeRouteInfo(route_info.weight, route_info.edges));
+            }
+            return result;
+        }
+
+        void TransportRouter::CheckCatalogueVersion() const {
+            if (catalogue_version_ != catalogue_.GetVersion()) {
+                throw std::logic_error("Catalogue has changed since the router was built, ApplyCatalogueChanges should be called before routing");
+            }
+        }
+
+        Info::Route TransportRouter::MakeRouteInfo(Minutes total_time, const std::vector<graph::EdgeId>& edges) const {
+            Info::Route result;
+            result.not_found = false;
+            result.total_time = total_time;
+            size_t boarding_count = 0;
+            for (const auto& edge_id : edges) {
+                const EdgeLabel& label = edge_labels_[edge_id];
+                if (label.span_count == 0) {
+                    ++boarding_count;
+                    result.items_.emplace_back(Info::Router::WaitInfo{catalogue_.GetStop(vertex_to_stop_[edges_[edge_id].from]).name, settings_.bus_wait_time});
+                } else {
+                    result.items_.emplace_back(Info::Router::BusRouteInfo{bus_names_[label.bus_id], label.span_count, graph_.GetEdge(edge_id).weight});
                 }
             }
+            result.transfer_count = boarding_count > 0 ? boarding_count - 1 : 0;
             return result;
         }
 
-        void TransportRouter::AddEdges() {
-            // добавляем ребра внутри одной остановки между посадкой и высадкой
-            for (const auto& [stop_name, stop_ptr] : catalogue_.GetReferenseStops()) {
-                auto edge_id = graph_.AddEdge({vertexes_.at(stop_name).portal, vertexes_.at(stop_name).hub, settings_.bus_wait_time});
-                id_to_wait_info_[edge_id] = {stop_name, settings_.bus_wait_time};
+        Info::Matrix TransportRouter::GetMatrixInfo(const std::vector<std::string>& stops_from, const std::vector<std::string>& stops_to) const {
+            CheckCatalogueVersion();
+            if (raptor_router_) {
+                return raptor_router_->GetMatrixInfo(stops_from, stops_to);
             }
-            // добавляем рёбра между остановками автобуса
-            for (const auto& [bus_name, bus_ptr] : catalogue_.GetReferenseBuses()) {
-                ConnectBusStops(bus_ptr->stops_of_the_bus.begin(), bus_ptr->stops_of_the_bus.end(), bus_name);
-                if (!bus_ptr->is_roundtrip) {
-                    ConnectBusStops(bus_ptr->stops_of_the_bus.rbegin(), bus_ptr->stops_of_the_bus.rend(), bus_name);
+            auto get_vertexes = [this](const std::vector<std::string>& stops) {
+                std::vector<graph::VertexId> result;
+                result.reserve(stops.size());
+                for (const auto& stop : stops) {
+                    result.push_back(vertexes_.at(stop).portal);
+                }
+                return result;
+            };
+            Info::Matrix result;
+            result.total_times = router_->BuildWeightsMatrix(get_vertexes(stops_from), get_vertexes(stops_to));
+            return result;
+        }
+
+        Info::Isochrone TransportRouter::GetIsochroneInfo(std::string_view stop_from, Minutes max_time) const {
+            CheckCatalogueVersion();
+            if (raptor_router_) {
+                return raptor_router_->GetIsochroneInfo(stop_from, max_time);
+            }
+            Info::Isochrone result;
+            for (const auto& [vertex, time] : graph::FindReachableVertices(graph_, vertexes_.at(stop_from).portal, max_time)) {
+                //в hub можно попасть только из portal той же остановки, поэтому он не раньше
+                std::string_view stop_name = catalogue_.GetStop(vertex_to_stop_[vertex]).name;
+                if (vertexes_.at(stop_name).portal == vertex) {
+                    result.stops.emplace_back(stop_name, time);
                 }
             }
+            return result;
+        }
+
+        cache::Stats TransportRouter::GetRouteCacheStats() const {
+            return route_cache_->GetStats();
+        }
+
+        std::optional<cache::Stats> TransportRouter::GetTreeCacheStats() const {
+            if (const auto* dijkstra_router = dynamic_cast<const graph::DijkstraRouter<Minutes>*>(router_.get())) {
+                return dijkstra_router->GetTreeCacheStats();
+            }
+            return std::nullopt;
+        }
+
+        void TransportRouter::BuildTopology() {
+            counter_ = 0;
+            vertexes_.clear();
+            vertex_to_stop_.clear();
+            edges_.clear();
+            edge_labels_.clear();
+            bus_to_edges_.clear();
+            bus_names_.clear();
+            bus_name_to_id_.clear();
+            for (const auto& [stop_name, stop] : catalogue_.GetReferenseStops()) {
+                AddStopToTopology(stop_name, stop);
+            }
+            for (const auto& [bus_name, bus] : catalogue_.GetReferenseBuses()) {
+                AddBusToTopology(catalogue_.GetBus(bus));
+            }
+            has_topology_ = true;
         }
 
+        void TransportRouter::AddStopToTopology(std::string_view stop_name, StopId stop) {
+            auto& vertex_ids = vertexes_[stop_name];
+            vertex_ids.portal = counter_++;
+            vertex_ids.hub = counter_++;
+            vertex_to_stop_.push_back(stop);
+            vertex_to_stop_.push_back(stop);
+            // добавляем ребро внутри одной остановки между посадкой и высадкой
+            edges_.push_back({vertex_ids.portal, vertex_ids.hub, 0.});
+            edge_labels_.push_back({});
+        }
+
+        void TransportRouter::AddBusToTopology(const Bus& bus) {
+            const auto& bus_stops = bus.stops_of_the_bus;
+            if (bus_stops.size() > std::numeric_limits<std::uint16_t>::max()) {
+                throw std::length_error("Bus has too many stops");
+            }
+            // добавляем рёбра между остановками автобуса
+            const std::uint32_t bus_id = GetBusId(bus.name);
+            auto& bus_edges = bus_to_edges_[bus.name];
+            ConnectBusStops(bus_stops.begin(), bus_stops.end(), bus_id, bus_edges);
+            if (!bus.is_roundtrip) {
+                ConnectBusStops(std::make_reverse_iterator(bus_stops.end()), std::make_reverse_iterator(bus_stops.begin()), bus_id, bus_edges);
+            }
+        }
+
+        std::uint32_t TransportRouter::GetBusId(std::string_view bus_name) {
+            const auto [it, inserted] = bus_name_to_id_.emplace(bus_name, static_cast<std::uint32_t>(bus_names_.size()));
+            if (inserted) {
+                bus_names_.push_back(bus_name);
+            }
+            return it->second;
+        }
+
+        // Граф собирается из топологии с весами по текущим настройкам
         void TransportRouter::SetGraph() {
-            AddVertexes();
             graph_ = graph::DirectedWeightedGraph<Minutes>(counter_);
-            AddEdges();
+            for (graph::EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+                const auto& edge = edges_[edge_id];
+                const Minutes weight = edge_labels_[edge_id].span_count == 0 ? settings_.bus_wait_time : CalculateBusTime(edge.distance);
+                graph_.AddEdge({edge.from, edge.to, weight});
+            }
+            //входящие дуги нужны только поиску навстречу
+            graph_.Freeze(settings_.router_type == Info::Router::RouterType::BIDIRECTIONAL);
+            //посадка в автобус - ребро ожидания
+            pareto_router_ = std::make_unique<graph::ParetoRouter<Minutes>>(graph_, [this](graph::EdgeId edge_id) {
+                return edge_labels_[edge_id].span_count == 0;
+            });
         }
 
-        void TransportRouter::AddVertexes() {
-            for (const auto& [stop_name, stop_ptr] : catalogue_.GetReferenseStops()) {
-                vertexes_[stop_name].portal = counter_++; 
-                vertexes_[stop_name].hub = counter_++;
+        size_t TransportRouter::GetRouterThreads() const {
+            return settings_.router_threads ? settings_.router_threads : std::thread::hardware_concurrency();
+        }
+
+        void TransportRouter::SetRouter() {
+            switch (settings_.router_type) {
+                case Info::Router::RouterType::ALL_PAIRS:
+                    router_ = std::make_unique<graph::Router<Minutes>>(graph_, GetRouterThreads());
+                    break;
+                case Info::Router::RouterType::DIJKSTRA:
+                    router_ = std::make_unique<graph::DijkstraRouter<Minutes>>(graph_, settings_.tree_cache_bytes);
+                    break;
+                case Info::Router::RouterType::ASTAR:
+                    SetMinutesPerMetr();
+                    router_ = std::make_unique<graph::AStarRouter<Minutes>>(graph_, [this](graph::VertexId from, graph::VertexId to) {
+                        return ComputeLowerBoundTime(from, to);
+                    });
+                    break;
+                case Info::Router::RouterType::BIDIRECTIONAL:
+                    SetMinutesPerMetr();
+                    router_ = std::make_unique<graph::BidirectionalRouter<Minutes>>(graph_, [this](graph::VertexId from, graph::VertexId to) {
+                        return ComputeLowerBoundTime(from, to);
+                    });
+                    break;
+                case Info::Router::RouterType::CONTRACTION_HIERARCHY:
+                    router_ = std::make_unique<graph::ContractionHierarchy<Minutes>>(graph_);
+                    break;
+                case Info::Router::RouterType::RAPTOR:
+                    break;
             }
         }
-        
-    }
-}
 
+        void TransportRouter::SetRaptorRouter() {
+            raptor_router_ = std::make_unique<RaptorRouter>(settings_.bus_wait_time);
+            for (const auto& [stop_name, stop] : catalogue_.GetReferenseStops()) {
+                raptor_router_->AddStop(stop_name);
+            }
+
+            for (const auto& [bus_name, bus] : catalogue_.GetReferenseBuses()) {
+                AddBusToRaptorRouter(catalogue_.GetBus(bus));
+            }
+        }
 
+        void TransportRouter::AddBusToRaptorRouter(const Bus& bus) {
+            std::vector<std::string_view> stops;
+            std::vector<Minutes> times;
+            auto add_line = [&](auto begin, auto end) {
+                stops.clear();
+                times.clear();
+                for (auto it = begin; it != end; ++it) {
+                    if (it != begin) {
+                        times.push_back(CalculateTimeBetweenStops(*std::prev(it), *it));
+                    }
+                    stops.push_back(catalogue_.GetStop(*it).name);
+                }
+                raptor_router_->AddLine(bus.name, stops, times);
+            };
+            const auto& bus_stops = bus.stops_of_the_bus;
+            add_line(bus_stops.begin(), bus_stops.end());
+            if (!bus.is_roundtrip) {
+                add_line(std::make_reverse_iterator(bus_stops.end()), std::make_reverse_iterator(bus_stops.begin()));
+            }
+        }
+
+        // Дорожное расстояние может оказаться короче расстояния по прямой, поэтому вместо скорости автобуса
+        // берём наименьшее время на метр прямой среди всех перегонов: так оценка остаётся допустимой
+        void TransportRouter::SetMinutesPerMetr() {
+            std::optional<double> minutes_per_metr;
+            auto update_minutes_per_metr = [&](StopId from, StopId to) {
+                const double geo_distance = Geo::ComputeDistance(catalogue_.GetStop(from).coordinates, catalogue_.GetStop(to).coordinates);
+                if (geo_distance > 0.) {
+                    const double ratio = CalculateTimeBetweenStops(from, to) / geo_distance;
+                    minutes_per_metr = minutes_per_metr ? std::min(*minutes_per_metr, ratio) : ratio;
+                }
+            };
+            for (BusId bus_id = 0; bus_id < catalogue_.GetBusCount(); ++bus_id) {
+                const Bus bus = catalogue_.GetBus(bus_id);
+                const auto& stops = bus.stops_of_the_bus;
+                for (size_t i = 1; i < stops.size(); ++i) {
+                    update_minutes_per_metr(stops[i - 1], stops[i]);
+                    if (!bus.is_roundtrip) {
+                        update_minutes_per_metr(stops[i], stops[i - 1]);
+                    }
+                }
+            }
+            minutes_per_metr_ = minutes_per_metr.value_or(0.);
+        }
+
+        Minutes TransportRouter::ComputeLowerBoundTime(graph::VertexId from, graph::VertexId to) const {
+            return Geo::ComputeDistance(catalogue_.GetStop(vertex_to_stop_[from]).coordinates,
+                                        catalogue_.GetStop(vertex_to_stop_[to]).coordinates) * minutes_per_metr_;
+        }
+
+        // Отпечаток всего, от чего зависят граф и таблица маршрутов: настроек, остановок, автобусов и расстояний
+        std::uint64_t TransportRouter::ComputeFingerprint() const {
+            Fingerprint fingerprint;
+            fingerprint.AddValue(settings_.bus_velocity);
+            fingerprint.AddValue(settings_.bus_wait_time);
+
+            std::vector<std::string_view> stop_names;
+            for (const auto& [stop_name, stop] : catalogue_.GetReferenseStops()) {
+                stop_names.push_back(stop_name);
+            }
+            std::sort(stop_names.begin(), stop_names.end());
+            fingerprint.AddValue(stop_names.size());
+            for (const auto stop_name : stop_names) {
+                fingerprint.AddString(stop_name);
+            }
+
+            std::vector<std::pair<std::string_view, BusId>> buses(catalogue_.GetReferenseBuses().begin(),
+                                                                  catalogue_.GetReferenseBuses().end());
+            std::sort(buses.begin(), buses.end());
+            fingerprint.AddValue(buses.size());
+            for (const auto& [bus_name, bus_id] : buses) {
+                const Bus bus = catalogue_.GetBus(bus_id);
+                const auto& stops = bus.stops_of_the_bus;
+                fingerprint.AddString(bus_name);
+                fingerprint.AddValue(bus.is_roundtrip);
+                fingerprint.AddValue(stops.size());
+                for (size_t i = 0; i < stops.size(); ++i) {
+                    fingerprint.AddString(catalogue_.GetStop(stops[i]).name);
+                    if (i > 0) {
+                        fingerprint.AddValue(catalogue_.GetDistanceBetweenStops(stops[i - 1], stops[i]));
+                        fingerprint.AddValue(catalogue_.GetDistanceBetweenStops(stops[i], stops[i - 1]));
+                    }
+                }
+            }
+            return fingerprint.Get();
+        }
+
+        bool TransportRouter::LoadRoutingData() {
+            std::shared_ptr<const storage::MappedFile> file;
+            try {
+                file = std::make_shared<const storage::MappedFile>(settings_.routing_data_file);
+            } catch (const std::runtime_error&) {
+                return false;
+            }
+            const char* data = file->GetData();
+            const size_t size = file->GetSize();
+            if (size < sizeof(RoutingDataHeader)) {
+                return false;
+            }
+            const auto header = ReadRecord<RoutingDataHeader>(data, 0);
+            if (std::memcmp(header.magic, ROUTING_DATA_MAGIC, sizeof(ROUTING_DATA_MAGIC)) != 0
+                || header.version != ROUTING_DATA_VERSION
+                || header.byte_order_mark != BYTE_ORDER_MARK
+                || header.weight_size != sizeof(Minutes)
+                || (header.edge_index_size != sizeof(std::uint32_t) && header.edge_index_size != sizeof(graph::EdgeId))
+                || header.fingerprint != ComputeFingerprint()) {
+                return false;
+            }
+            if (header.vertex_count > size || header.edge_count > size || header.stop_count > size || header.names_size > size
+                || (header.vertex_count > 0 && header.vertex_count > size / header.vertex_count)) {
+                return false;
+            }
+            const size_t vertex_count = header.vertex_count;
+            const size_t stops_offset = sizeof(RoutingDataHeader);
+            const size_t edges_offset = stops_offset + header.stop_count * sizeof(StopRecord);
+            const size_t names_offset = edges_offset + header.edge_count * sizeof(EdgeRecord);
+            const size_t weights_offset = AlignSection(names_offset + header.names_size);
+            const size_t prev_edges_offset = weights_offset + vertex_count * vertex_count * sizeof(Minutes);
+            if (prev_edges_offset + vertex_count * vertex_count * header.edge_index_size != size) {
+                return false;
+            }
+            auto get_name = [&](std::uint64_t name_offset, std::uint64_t name_size) -> std::optional<std::string_view> {
+                if (name_offset > header.names_size || name_size > header.names_size - name_offset) {
+                    return std::nullopt;
+                }
+                return std::string_view(data + names_offset + name_offset, name_size);
+            };
+
+            // всё читаем во временные структуры, чтобы при ошибке не испортить состояние
+            const auto& stops = catalogue_.GetReferenseStops();
+            std::unordered_map<std::string_view, graph::VertexIds> vertexes;
+            std::vector<StopId> vertex_to_stop(vertex_count);
+            for (size_t i = 0; i < header.stop_count; ++i) {
+                const auto record = ReadRecord<StopRecord>(data + stops_offset, i);
+                const auto name = get_name(record.name_offset, record.name_size);
+                const auto stop_it = name ? stops.find(*name) : stops.end();
+                if (stop_it == stops.end() || record.portal >= vertex_count || record.hub >= vertex_count) {
+                    return false;
+                }
+                vertexes[stop_it->first] = {record.portal, record.hub};
+                vertex_to_stop[record.portal] = stop_it->second;
+                vertex_to_stop[record.hub] = stop_it->second;
+            }
+
+            const auto& buses = catalogue_.GetReferenseBuses();
+            std::vector<EdgeTopology> edges;
+            std::vector<EdgeLabel> edge_labels;
+            std::unordered_map<std::string_view, std::vector<graph::EdgeId>> bus_to_edges;
+            std::vector<std::string_view> bus_names;
+            std::unordered_map<std::string_view, std::uint32_t> bus_name_to_id;
+            for (size_t i = 0; i < header.edge_count; ++i) {
+                const auto record = ReadRecord<EdgeRecord>(data + edges_offset, i);
+                const auto name = get_name(record.name_offset, record.name_size);
+                if (!name || record.from >= vertex_count || record.to >= vertex_count) {
+                    return false;
+                }
+                const graph::EdgeId edge_id = edges.size();
+                edges.push_back({record.from, record.to, record.distance});
+                if (record.kind == EdgeKind::WAIT) {
+                    const auto stop_it = stops.find(*name);
+                    if (stop_it == stops.end() || vertex_to_stop[record.from] != stop_it->second) {
+                        return false;
+                    }
+                    edge_labels.push_back({});
+                } else {
+                    const auto bus_it = buses.find(*name);
+                    if (bus_it == buses.end() || record.span_count <= 0 || record.span_count > std::numeric_limits<std::uint16_t>::max()) {
+                        return false;
+                    }
+                    const auto [id_it, inserted] = bus_name_to_id.emplace(bus_it->first, static_cast<std::uint32_t>(bus_names.size()));
+                    if (inserted) {
+                        bus_names.push_back(bus_it->first);
+                    }
+                    edge_labels.push_back({id_it->second, static_cast<std::uint16_t>(record.span_count)});
+                    bus_to_edges[bus_it->first].push_back(edge_id);
+                }
+            }
+
+            graph::Router<Minutes>::RoutesTableVariant routes_table;
+            const auto* weights = reinterpret_cast<const Minutes*>(data + weights_offset);
+            if (header.edge_index_size == sizeof(std::uint32_t)) {
+                if (header.edge_count >= graph::Router<Minutes>::CompactRoutesTable::NO_EDGE) {
+                    return false;
+                }
+                routes_table = graph::Router<Minutes>::CompactRoutesTable{weights, reinterpret_cast<const std::uint32_t*>(data + prev_edges_offset)};
+            } else {
+                routes_table = graph::Router<Minutes>::WideRoutesTable{weights, reinterpret_cast<const graph::EdgeId*>(data + prev_edges_offset)};
+            }
+
+            counter_ = vertex_count;
+            vertexes_ = std::move(vertexes);
+            vertex_to_stop_ = std::move(vertex_to_stop);
+            edges_ = std::move(edges);
+            edge_labels_ = std::move(edge_labels);
+            bus_to_edges_ = std::move(bus_to_edges);
+            bus_names_ = std::move(bus_names);
+            bus_name_to_id_ = std::move(bus_name_to_id);
+            has_topology_ = true;
+            SetGraph();
+            router_ = std::make_unique<graph::Router<Minutes>>(graph_, routes_table, std::move(file));
+            return true;
+        }
+
+        bool TransportRouter::SaveRoutingData() const {
+            const auto& router = dynamic_cast<const graph::Router<Minutes>&>(*router_);
+            const auto routes_table = router.GetRoutesTable();
+            const size_t vertex_count = graph_.GetVertexCount();
+
+            std::string names;
+            std::unordered_map<std::string_view, std::uint64_t> name_offsets;
+            auto add_name = [&](std::string_view name) {
+                const auto [it, inserted] = name_offsets.emplace(name, names.size());
+                if (inserted) {
+                    names += name;
+                }
+                return it->second;
+            };
+
+            std::vector<StopRecord> stop_records;
+            stop_records.reserve(vertexes_.size());
+            for (const auto& [stop_name, vertex_ids] : vertexes_) {
+                stop_records.push_back({add_name(stop_name), stop_name.size(), vertex_ids.portal, vertex_ids.hub});
+            }
+
+            std::vector<EdgeRecord> edge_records;
+            edge_records.reserve(edges_.size());
+            for (graph::EdgeId edge_id = 0; edge_id < edges_.size(); ++edge_id) {
+                const auto& edge = edges_[edge_id];
+                EdgeRecord record{edge.from, edge.to, edge.distance, 0, 0, EdgeKind::WAIT, 0};
+                const EdgeLabel& label = edge_labels_[edge_id];
+                const std::string_view name = label.span_count == 0 ? catalogue_.GetStop(vertex_to_stop_[edge.from]).name
+                                                                    : bus_names_[label.bus_id];
+                record.name_offset = add_name(name);
+                record.name_size = name.size();
+                if (label.span_count > 0) {
+                    record.kind = EdgeKind::BUS;
+                    record.span_count = label.span_count;
+                }
+                edge_records.push_back(record);
+            }
+
+            RoutingDataHeader header{};
+            std::memcpy(header.magic, ROUTING_DATA_MAGIC, sizeof(ROUTING_DATA_MAGIC));
+            header.version = ROUTING_DATA_VERSION;
+            header.byte_order_mark = BYTE_ORDER_MARK;
+            header.fingerprint = ComputeFingerprint();
+            header.vertex_count = vertex_count;
+            header.edge_count = edge_records.size();
+            header.stop_count = stop_records.size();
+            header.names_size = names.size();
+            header.weight_size = sizeof(Minutes);
+            header.edge_index_size = std::visit([](const auto& routes) {
+                return static_cast<std::uint32_t>(sizeof(*routes.prev_edges));
+            }, routes_table);
+
+            // пишем во временный файл и переименовываем, чтобы другой процесс не прочитал недописанный файл
+            const std::string temp_path = settings_.routing_data_file + ".tmp";
+            bool is_written = false;
+            {
+                std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+                if (!out.is_open()) {
+                    return false;
+                }
+                auto write = [&out](const void* data, size_t size) {
+                    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+                };
+                write(&header, sizeof(header));
+                write(stop_records.data(), stop_records.size() * sizeof(StopRecord));
+                write(edge_records.data(), edge_records.size() * sizeof(EdgeRecord));
+                write(names.data(), names.size());
+                const size_t names_end = sizeof(header) + stop_records.size() * sizeof(StopRecord)
+                                       + edge_records.size() * sizeof(EdgeRecord) + names.size();
+                const char padding[SECTION_ALIGNMENT] = {};
+                write(padding, AlignSection(names_end) - names_end);
+                std::visit([&](const auto& routes) {
+                    write(routes.weights, vertex_count * vertex_count * sizeof(*routes.weights));
+                    write(routes.prev_edges, vertex_count * vertex_count * sizeof(*routes.prev_edges));
+                }, routes_table);
+                out.close();
+                is_written = static_cast<bool>(out);
+            }
+            if (!is_written || std::rename(temp_path.c_str(), settings_.routing_data_file.c_str()) != 0) {
+                std::remove(temp_path.c_str());
+                return false;
+            }
+            return true;
+        }
+
+    }
+}
@@ -1,9 +1,21 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <thread>
 #include <vector>
 #include <unordered_map>
 
+#include "astar_router.h"
+#include "contraction_hierarchy.h"
+#include "dijkstra_router.h"
+#include "lru_cache.h"
+#include "mapped_file.h"
+#include "pareto_router.h"
+#include "raptor_router.h"
+#include "reachability.h"
 #include "router.h"
 #include "transport_catalogue.h"
 
@@ -17,47 +29,131 @@ namespace TransportCatalogue{
         class TransportRouter {
         public:
             TransportRouter(TransportCatalogue& catalogue);
+            // Топология графа строится один раз: при смене настроек пересчитываются только веса рёбер и данные алгоритма
             void SetSettings(Info::Router::RoutingSettings& settings);
+            // Дочитывает журнал изменений справочника с версии, с которой собран маршрутизатор: пересобираются рёбра
+            // только изменённых автобусов и автобусов через остановки с новыми расстояниями. Вызывается перед запросами:
+            // пока изменения не применены, запросы бросают logic_error, а не отвечают по устаревшим данным
+            void ApplyCatalogueChanges();
             Info::Route GetRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to) const;
+            // Самый быстрый маршрут не больше чем с max_transfers пересадками
+            Info::Route GetRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to, size_t max_transfers) const;
+            // Все маршруты, недоминируемые по времени и числу пересадок; только для алгоритмов на графе
+            Info::ParetoRoutes GetParetoRoutesInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to,
+                                                   std::optional<size_t> max_transfers = std::nullopt) const;
+            Info::Matrix GetMatrixInfo(const std::vector<std::string>& stops_from, const std::vector<std::string>& stops_to) const;
+            // Остановки, до которых можно доехать от stop_from не дольше чем за max_time минут
+            Info::Isochrone GetIsochroneInfo(std::string_view stop_from, Minutes max_time) const;
+            //кэш готовых ответов на Route; очищается при смене настроек и изменении справочника
+            cache::Stats GetRouteCacheStats() const;
+            std::optional<cache::Stats> GetTreeCacheStats() const;
         private:
-            void AddEdges();
-            void AddVertexes();
+            using StopsPair = std::pair<StopId, StopId>;
+
+            class StopsPairHasher {
+            public:
+                size_t operator()(const StopsPair& stops_pair) const {
+                    return std::hash<std::uint64_t>{}((static_cast<std::uint64_t>(stops_pair.first) << 32) | stops_pair.second);
+                }
+            };
+            using RouteCache = cache::LruCache<StopsPair, std::shared_ptr<const Info::Route>, StopsPairHasher>;
+
+            // Ребро графа без веса: вес зависит от настроек и пересчитывается при их смене
+            struct EdgeTopology {
+                graph::VertexId from = 0;
+                graph::VertexId to = 0;
+                //для ребра автобуса - длина пути по дорогам в метрах
+                double distance = 0.;
+            };
+
+            // Описание ребра для ответа. span_count == 0 - ожидание на остановке vertex_to_stop_[from],
+            // иначе поездка на автобусе bus_names_[bus_id] через span_count перегонов; время - вес ребра в графе
+            struct EdgeLabel {
+                std::uint32_t bus_id = 0;
+                std::uint16_t span_count = 0;
+            };
+
+            void Build();
+            void BuildTopology();
+            //возвращает, были ли среди bus_names автобусы графа
+            bool RemoveBusesFromTopology(const std::vector<std::string_view>& bus_names);
+            void AddStopToTopology(std::string_view stop_name, StopId stop);
+            void AddBusToTopology(const Bus& bus);
+            std::uint32_t GetBusId(std::string_view bus_name);
             void SetGraph();
+            void SetRouter();
+            size_t GetRouterThreads() const;
+            void SetRaptorRouter();
+            void AddBusToRaptorRouter(const Bus& bus);
+            void SetMinutesPerMetr();
+            //загружает граф и таблицу маршрутов из файла, если он построен для того же справочника и настроек
+            bool LoadRoutingData();
+            //при ошибке записи удаляет недописанный файл и возвращает false
+            bool SaveRoutingData() const;
+            //сохраняет данные маршрутизации, при ошибке только предупреждает
+            void UpdateRoutingDataFile() const;
+            std::uint64_t ComputeFingerprint() const;
+            Minutes ComputeLowerBoundTime(graph::VertexId from, graph::VertexId to) const;
+            void CheckCatalogueVersion() const;
+            Info::Route ComputeRouteInfo(std::pair<std::string_view, std::string_view> pair_stop_from_to) const;
+            Info::Route MakeRouteInfo(Minutes total_time, const std::vector<graph::EdgeId>& edges) const;
             
-            Minutes CalculateTimeBetweenStops(Stop* stop_ptr_from, Stop* stop_ptr_to) const {
-                return  catalogue_.GetDistanceBetweenStops(stop_ptr_from, stop_ptr_to) * MINUTES_IN_HOUR / (settings_.bus_velocity * METRS_IN_KILOMETR);
+            Minutes CalculateTimeBetweenStops(StopId stop_from, StopId stop_to) const {
+                return CalculateBusTime(catalogue_.GetDistanceBetweenStops(stop_from, stop_to));
+            }
+
+            Minutes CalculateBusTime(double distance) const {
+                return distance * MINUTES_IN_HOUR / (settings_.bus_velocity * METRS_IN_KILOMETR);
             }
 
             template <typename It>
-            void ConnectBusStops(It begin, It end, std::string_view bus_name) {
+            void ConnectBusStops(It begin, It end, std::uint32_t bus_id, std::vector<graph::EdgeId>& bus_edges) {
                 for(auto from_it = begin; from_it != std::prev(end); from_it++) {
-                    Minutes weight = 0.;
-                    int span_count = 0;
+                    double distance = 0.;
+                    std::uint16_t span_count = 0;
                     
                     for(auto to_it = std::next(from_it); to_it != end; to_it++) {
-                        std::string_view from_stop = (*from_it)->name;
+                        std::string_view from_stop = catalogue_.GetStop(*from_it).name;
                         auto vertex_from_stop = vertexes_.at(from_stop).hub;
 
-                        std::string_view to_stop = (*to_it)->name;
+                        std::string_view to_stop = catalogue_.GetStop(*to_it).name;
                         auto vertex_to_stop = vertexes_.at(to_stop).portal;
 
-                        weight += CalculateTimeBetweenStops(*std::prev(to_it), *to_it);
+                        distance += catalogue_.GetDistanceBetweenStops(*std::prev(to_it), *to_it);
                         span_count++;
 
-                        auto bus_edge_id = graph_.AddEdge({vertex_from_stop, vertex_to_stop, weight});
-                        id_to_bus_route_info[bus_edge_id] = {bus_name, span_count, weight};
+                        const graph::EdgeId bus_edge_id = edges_.size();
+                        edges_.push_back({vertex_from_stop, vertex_to_stop, distance});
+                        edge_labels_.push_back({bus_id, span_count});
+                        bus_edges.push_back(bus_edge_id);
                     }  
                 }
             }
 
             graph::DirectedWeightedGraph<Minutes> graph_;
-            std::unique_ptr<graph::Router<Minutes>> router_ = nullptr;
+            std::unique_ptr<graph::RouterEngine<Minutes>> router_ = nullptr;
+            //для RAPTOR граф не строится
+            std::unique_ptr<RaptorRouter> raptor_router_ = nullptr;
+            //поиск по времени и числу пересадок на том же графе
+            std::unique_ptr<graph::ParetoRouter<Minutes>> pareto_router_ = nullptr;
             Info::Router::RoutingSettings settings_;
             TransportCatalogue& catalogue_;
+            //версия справочника, с которой собраны топология и алгоритм
+            std::uint64_t catalogue_version_ = 0;
             graph::VertexId counter_ = 0;
+            //топология строится только для алгоритмов на графе
+            bool has_topology_ = false;
+            std::vector<EdgeTopology> edges_;
+            std::vector<EdgeLabel> edge_labels_;
+            std::unordered_map<std::string_view, std::vector<graph::EdgeId>> bus_to_edges_;
+            //имена автобусов по номерам из EdgeLabel; номер закреплён за именем и достаётся автобусу, заменившему удалённый
+            std::vector<std::string_view> bus_names_;
+            std::unordered_map<std::string_view, std::uint32_t> bus_name_to_id_;
             std::unordered_map<std::string_view, graph::VertexIds> vertexes_;
-            std::unordered_map<graph::EdgeId, Info::Router::WaitInfo> id_to_wait_info_;
-            std::unordered_map<graph::EdgeId, Info::Router::BusRouteInfo> id_to_bus_route_info;
+            std::vector<StopId> vertex_to_stop_;
+            std::unique_ptr<RouteCache> route_cache_;
+            //минимальное время на метр расстояния по прямой среди всех перегонов
+            double minutes_per_metr_ = 0.;
 
         };
 